@@ -1,13 +1,72 @@
 namespace Imogen
 {
+template <typename Dest, typename Source>
+static void convertSamples (const juce::AudioBuffer<Source>& source, juce::AudioBuffer<Dest>& dest)
+{
+	const auto numSamples = source.getNumSamples();
+
+	for (auto chan = 0; chan < source.getNumChannels(); ++chan)
+	{
+		const auto* in	= source.getReadPointer (chan);
+		auto*		out = dest.getWritePointer (chan);
+
+		for (auto i = 0; i < numSamples; ++i)
+			out[i] = static_cast<Dest> (in[i]);
+	}
+}
+
 template <typename SampleType>
 Engine<SampleType>::Engine (State& stateToUse)
 	: state (stateToUse)
 {
 }
 
+/* Silence is passed from stage to stage: once the gate has closed (or the input is silent) and
+   every harmony voice has finished, each stage stops running as soon as its own tail has died
+   away, so an idle engine does little more than check its input for silence.
+ */
 template <typename SampleType>
 void Engine<SampleType>::renderChunk (const AudioBuffer& input, AudioBuffer& output, MidiBuffer& midiMessages, bool)
+{
+	addInjectedMidi (midiMessages, input.getNumSamples());
+
+	if constexpr (convertsAtBoundary)
+	{
+		const auto numSamples = input.getNumSamples();
+
+		jassert (input.getNumChannels() <= kernelInput.getNumChannels() && output.getNumChannels() <= kernelOutput.getNumChannels());
+		jassert (numSamples <= kernelInput.getNumSamples());
+
+		KernelBuffer in { kernelInput.getArrayOfWritePointers(), input.getNumChannels(), numSamples };
+		KernelBuffer out { kernelOutput.getArrayOfWritePointers(), output.getNumChannels(), numSamples };
+
+		convertSamples (input, in);
+
+		renderKernels (in, out, midiMessages);
+
+		convertSamples (out, output);
+	}
+	else
+	{
+		renderKernels (input, output, midiMessages);
+	}
+}
+
+template <typename SampleType>
+void Engine<SampleType>::addInjectedMidi (MidiBuffer& midiMessages, int numSamples)
+{
+	injectedMidi.clear();
+	state.midiInput.drain (injectedMidi, numSamples);
+
+	if (injectedMidi.isEmpty())
+		return;
+
+	// merged straight into the host's buffer, so that none of the engine's buffers swap storage with it
+	midiMessages.addEvents (injectedMidi, 0, -1, 0);
+}
+
+template <typename SampleType>
+void Engine<SampleType>::renderKernels (const KernelBuffer& input, KernelBuffer& output, MidiBuffer& midiMessages)
 {
 	output.clear();
 	updateStereoWidth (parameters.stereoWidth->get());
@@ -17,21 +76,210 @@ void Engine<SampleType>::renderChunk (const AudioBuffer& input, AudioBuffer& out
 
 	const auto numSamples = input.getNumSamples();
 
+	const auto measuring = state.telemetry.beginBlock (numSamples);
+
+	// nothing is analyzed while fully bypassed, so the pitches stop being sent too
+	const auto sendPitches	= parameters.midiState.pitchToMidi->get() && ! (leadIsBypassed && harmoniesAreBypassed);
+	const auto stopsSending = wasSendingPitches && ! sendPitches;
+
+	// after a re-prepare the lead's note is ended here, and tracking starts again from the next estimate
+	const auto endsLeadNote = stopsSending || std::exchange (pitchesRestart, false);
+
+	if (sendPitches && ! wasSendingPitches)
+		harmonizer.reannounceSoundingNotes();
+
+	wasSendingPitches = sendPitches;
+
+	const auto* preset = state.presets.takeSelectedPreset();
+
 	if (leadIsBypassed && harmoniesAreBypassed)
 	{
+		// the output is silent, so there's nothing to fade
+		if (preset != nullptr)
+			switchPreset (*preset, 0);
+
 		harmonizer.bypassedBlock (numSamples, midiMessages);
+
+		if (endsLeadNote)
+			pitchToMidi.stop (0, midiMessages);
+
+		if (stopsSending)
+			harmonizer.endSoundingNotes (0, midiMessages);
+
+		// nothing was measured, so the meters drop to silence
+		state.telemetry.publish();
+
+		return;
+	}
+
+	timings.time (EngineStage::preHarmonyEffects, [&]
+				  { preHarmonyEffects.process (input); });
+
+	processedMidi.clear();
+
+	if (endsLeadNote)
+		pitchToMidi.stop (0, processedMidi);
+
+	if (stopsSending)
+		harmonizer.endSoundingNotes (0, processedMidi);
+
+	// a new preset is switched to at the sub-block nearest the middle of the chunk
+	const auto numSubBlocks = (numSamples + subBlockSize - 1) / subBlockSize;
+	const auto switchAt		= preset == nullptr ? -1 : numSubBlocks > 1 ? numSubBlocks / 2 * subBlockSize : numSamples;
+
+	for (auto start = 0; start < numSamples; start += subBlockSize)
+	{
+		const auto subBlockSamples = std::min (subBlockSize, numSamples - start);
+
+		if (start == switchAt)
+			switchPreset (*preset, switchAt);
+
+		subBlockMidi.clear();
+		subBlockMidi.addEvents (midiMessages, start, subBlockSamples, -start);
+
+		const auto detectorPosition = pitchDetector.getNumSamplesProcessed();
+
+		renderSubBlock (start, subBlockSamples, output, leadIsBypassed, harmoniesAreBypassed);
+
+		// the harmonizer can add or consume events, so pass on what it left rather than the input
+		processedMidi.addEvents (subBlockMidi, 0, subBlockSamples, start);
+
+		if (sendPitches)
+			addPitchesToMidi (start, subBlockSamples, detectorPosition);
+
+		fadeAroundPresetSwitch (output, start, subBlockSamples, switchAt);
+	}
+
+	if (switchAt == numSamples)
+		switchPreset (*preset, switchAt);
+
+	// copied back rather than swapped, so that processedMidi keeps its own storage and never ends up
+	// with the host's buffer, which may be too small to fill without allocating
+	midiMessages.clear();
+	midiMessages.addEvents (processedMidi, 0, -1, 0);
+
+	if (measuring)
+		publishTelemetry (output);
+
+	timings.flush();
+}
+
+template <typename SampleType>
+void Engine<SampleType>::renderSubBlock (int start, int numSamples, KernelBuffer& output, bool leadIsBypassed, bool harmoniesAreBypassed)
+{
+	timings.accumulate (EngineStage::analysis, [&]
+						{
+							if (preHarmonyEffects.isInputSilent())
+							{
+								pitchDetector.process (nullptr, numSamples);
+								grainCache.analyzeSilence (numSamples);
+								return;
+							}
+
+							const auto* input = preHarmonyEffects.getProcessedInputSignal() + start;
+
+							pitchDetector.process (input, numSamples);
+							grainCache.analyze (input, numSamples, pitchDetector.getFrequency());
+						});
+
+	timings.accumulate (EngineStage::harmonizer, [&]
+						{ harmonizer.process (numSamples, subBlockMidi, harmoniesAreBypassed); });
+
+	timings.accumulate (EngineStage::leadProcessor, [&]
+						{ leadProcessor.process (leadIsBypassed, numSamples); });
+
+	subBlockOutput.setDataToReferTo (output.getArrayOfWritePointers(), output.getNumChannels(), start, numSamples);
+
+	timings.accumulate (EngineStage::postHarmonyEffects, [&]
+						{
+							const auto inputsAreSilent = harmonizer.isHarmonySignalSilent() && leadProcessor.isProcessedSignalSilent();
+
+							postHarmonyEffects.process (harmonizer.getHarmonySignal(), leadProcessor.getProcessedSignal(), subBlockOutput, inputsAreSilent);
+						});
+}
+
+/* The lead's pitch is read straight from the detector, at the sample where its latest estimate was
+   made, and the harmony notes are the ones the harmonizer reports its voices playing, so the MIDI
+   output costs next to nothing on top of the rendering.
+ */
+template <typename SampleType>
+void Engine<SampleType>::addPitchesToMidi (int start, int numSamples, juce::int64 detectorPositionBefore)
+{
+	processedMidi.addEvents (harmonizer.getHarmonyNoteEvents(), 0, numSamples, start);
+
+	const auto estimatePosition = pitchDetector.getLastEstimatePosition();
+
+	if (estimatePosition <= detectorPositionBefore)
+		return;
+
+	const auto offset = static_cast<int> (std::min (estimatePosition - detectorPositionBefore, static_cast<juce::int64> (numSamples - 1)));
+
+	pitchToMidi.process (pitchDetector.getFrequency(), start + offset, processedMidi);
+}
+
+/* The levels are measured once per chunk, on the processed input and the final output together, and
+   the stages have reported their gain reductions into the same record as they ran.
+ */
+template <typename SampleType>
+void Engine<SampleType>::publishTelemetry (const KernelBuffer& output)
+{
+	auto& record = state.telemetry.getRecord();
+
+	const auto numOutputChannels = std::min (2, output.getNumChannels());
+
+	const Kernel* channels[] = { preHarmonyEffects.getProcessedInputSignal(),
+								 output.getReadPointer (0),
+								 output.getReadPointer (numOutputChannels - 1) };
+
+	static_assert (TelemetryRecord::input == 0 && TelemetryRecord::outputLeft == 1 && TelemetryRecord::outputRight == 2);
+
+	measureLevels (channels, TelemetryRecord::numLevels, output.getNumSamples(), record.peak.data(), record.rms.data());
+
+	record.pitch = pitchDetector.getFrequency();
+
+	state.telemetry.publish();
+}
+
+template <typename SampleType>
+void Engine<SampleType>::switchPreset (const PresetLibrary::ParameterSet& preset, int fadeLength)
+{
+	state.presets.apply (preset);
+
+	// the groups are normally bumped by the parameters' listeners, which are only told later
+	parameters.markAllChanged();
+
+	presetFadeLength   = fadeLength;
+	presetFadePosition = 0;
+}
+
+/* Every parameter can jump at once when the preset changes, which would click, so the output fades
+   out over the part of the chunk before the switch and back in over as long again after it. The
+   engine can't render a block twice to crossfade the old and new settings, but the fade is over
+   within one chunk when the chunk has more than one sub-block.
+ */
+template <typename SampleType>
+void Engine<SampleType>::fadeAroundPresetSwitch (KernelBuffer& output, int start, int numSamples, int switchAt)
+{
+	if (start < switchAt)
+	{
+		const auto fadeOut = [switchAt] (int sample)
+		{ return static_cast<Kernel> (1) - static_cast<Kernel> (sample) / static_cast<Kernel> (switchAt); };
+
+		output.applyGainRamp (start, numSamples, fadeOut (start), fadeOut (start + numSamples));
 		return;
 	}
 
-	preHarmonyEffects.process (input);
+	if (presetFadePosition >= presetFadeLength)
+		return;
 
-	analyzer.analyzeInput (preHarmonyEffects.getProcessedInputSignal(), numSamples);
+	const auto rampSamples = std::min (numSamples, presetFadeLength - presetFadePosition);
 
-	harmonizer.process (numSamples, midiMessages, harmoniesAreBypassed);
+	const auto fadeIn = [this] (int sample)
+	{ return static_cast<Kernel> (sample) / static_cast<Kernel> (presetFadeLength); };
 
-	leadProcessor.process (leadIsBypassed, numSamples);
+	output.applyGainRamp (start, rampSamples, fadeIn (presetFadePosition), fadeIn (presetFadePosition + rampSamples));
 
-	postHarmonyEffects.process (harmonizer.getHarmonySignal(), leadProcessor.getProcessedSignal(), output);
+	presetFadePosition += rampSamples;
 }
 
 template <typename SampleType>
@@ -44,21 +292,55 @@ void Engine<SampleType>::updateStereoWidth (int width)
 template <typename SampleType>
 void Engine<SampleType>::onPrepare (int blocksize, double samplerate)
 {
+	const auto innerBlocksize = std::min (blocksize, subBlockSize);
+
 	if (! harmonizer.isInitialized())
-		harmonizer.initialize (16, samplerate, blocksize);
+		harmonizer.initialize (Internals::maxVoices, samplerate, innerBlocksize);
+
+	const auto& internals = state.internals;
+
+	// the analysis window must span two periods of the lowest pitch, so raising it is what lowers the latency
+	const auto pitchFloor = internals.lowLatencyMode->get() ? internals.lowLatencyPitchFloor->get() : Internals::normalPitchFloor;
 
-	analyzer.prepare (samplerate, blocksize);
+	grainCache.setMinInputFrequency (static_cast<float> (pitchFloor));
+	pitchDetector.setFrequencyRange (static_cast<float> (pitchFloor), GrainCache<Kernel>::maxInputFreq);
 
-	if (const auto latency = analyzer.getLatencySamples() > 0)
+	if constexpr (convertsAtBoundary)
 	{
-		dsp::LatencyEngine<SampleType>::changeLatency (latency);
-		return;
+		kernelInput.setSize (maxInputChannels, blocksize);
+		kernelOutput.setSize (2, blocksize);
 	}
 
-	harmonizer.prepare (samplerate, blocksize);
-	leadProcessor.prepare (samplerate, blocksize);
+	pitchDetector.prepare (samplerate);
+	pitchesRestart = true;
 	preHarmonyEffects.prepare (samplerate, blocksize);
-	postHarmonyEffects.prepare (samplerate, blocksize);
+
+	grainCache.prepare (samplerate, innerBlocksize);
+	harmonizer.prepare (samplerate, innerBlocksize);
+	leadProcessor.prepare (samplerate, innerBlocksize);
+	postHarmonyEffects.prepare (samplerate, innerBlocksize);
+
+	// the host's events can be joined by a whole queue of injected ones, and while pitches are sent
+	// the harmony notes can add up to two events for each of them
+	subBlockMidi.ensureSize (midiBufferBytes + MidiInputQueue::bufferBytes);
+	processedMidi.ensureSize (3 * (midiBufferBytes + MidiInputQueue::bufferBytes));
+	injectedMidi.ensureSize (MidiInputQueue::bufferBytes);
+
+	state.midiInput.prepare (samplerate);
+
+	// every stage's latency is only known once it has been prepared
+	auto& budget = state.latency;
+
+	budget.set (EngineStage::preHarmonyEffects, preHarmonyEffects.getLatencySamples());
+	budget.set (EngineStage::analysis, grainCache.getLatencySamples());
+	budget.set (EngineStage::harmonizer, harmonizer.getLatencySamples());
+	budget.set (EngineStage::leadProcessor, leadProcessor.getLatencySamples());
+	budget.set (EngineStage::postHarmonyEffects, postHarmonyEffects.getLatencySamples());
+
+	const auto latency = budget.getTotal();
+
+	if (latency != dsp::LatencyEngine<SampleType>::getLatency())
+		dsp::LatencyEngine<SampleType>::changeLatency (latency);
 }
 
 
@@ -2,6 +2,9 @@
 
 #include <imogen_state/imogen_state.h>
 
+#include "Precision.h"
+#include "Levels.h"
+#include "PSOLA/PitchDetector.h"
 #include "Lead/LeadProcessor.h"
 #include "effects/PostHarmonyEffects.h"
 #include "effects/PreHarmonyEffects.h"
@@ -19,24 +22,77 @@ public:
 
 private:
 
+	using Kernel	   = KernelType<SampleType>;
+	using KernelBuffer = juce::AudioBuffer<Kernel>;
+
+	static constexpr auto convertsAtBoundary = ! std::is_same_v<Kernel, SampleType>;
+
 	void renderChunk (const AudioBuffer& input, AudioBuffer& output, MidiBuffer& midiMessages, bool isBypassed) final;
 
+	void renderKernels (const KernelBuffer& input, KernelBuffer& output, MidiBuffer& midiMessages);
+
+	void addInjectedMidi (MidiBuffer& midiMessages, int numSamples);
+
+	void renderSubBlock (int start, int numSamples, KernelBuffer& output, bool leadIsBypassed, bool harmoniesAreBypassed);
+
+	void addPitchesToMidi (int start, int numSamples, juce::int64 detectorPositionBefore);
+
+	void publishTelemetry (const KernelBuffer& output);
+
+	void switchPreset (const PresetLibrary::ParameterSet& preset, int fadeLength);
+	void fadeAroundPresetSwitch (KernelBuffer& output, int start, int numSamples, int switchAt);
+
 	void onPrepare (int blocksize, double samplerate) final;
 
 	void updateStereoWidth (int width);
 
-	State&		state;
-	Parameters& parameters { state.parameters };
+	State&		  state;
+	Parameters&	  parameters { state.parameters };
+	StageTimings& timings { state.timings };
+
+	PitchDetector<Kernel> pitchDetector;
+
+	GrainCache<Kernel> grainCache;
+
+	PreHarmonyEffects<Kernel> preHarmonyEffects { state };
+
+	Harmonizer<Kernel> harmonizer { state, grainCache };
+
+	LeadProcessor<Kernel> leadProcessor { harmonizer, state };
+
+	PostHarmonyEffects<Kernel> postHarmonyEffects { state };
+
+	PitchToMidi pitchToMidi;
+
+	bool wasSendingPitches { false };
+
+	// set when the engine is re-prepared, so that the lead's note is ended at the next block
+	// rather than forgotten while the receiver still has it on
+	bool pitchesRestart { false };
+
+	// how long the fade back in after a preset switch is, and how far through it the engine is
+	int presetFadeLength { 0 }, presetFadePosition { 0 };
+
+	// only used when the engine converts at its boundary; the input has the main bus and the sidechain
+	static constexpr auto maxInputChannels = 3;
+
+	KernelBuffer kernelInput, kernelOutput;
 
-	dsp::psola::Analyzer<SampleType> analyzer;
+	/* Everything after the input effects runs in sub-blocks of at most this many samples, whatever
+	   size of chunk the host's block size and the latency add up to, so that the voices' working
+	   buffers stay small enough to live in cache.
+	 */
+	static constexpr auto subBlockSize = 64;
 
-	PreHarmonyEffects<SampleType> preHarmonyEffects { state };
+	// MIDI events for the current sub-block, and the events already processed this chunk
+	MidiBuffer subBlockMidi, processedMidi;
 
-	Harmonizer<SampleType> harmonizer { state, analyzer };
+	// events played from the GUI or the remote app that are due in the current chunk
+	MidiBuffer injectedMidi;
 
-	LeadProcessor<SampleType> leadProcessor { harmonizer, state };
+	static constexpr auto midiBufferBytes = 4096;
 
-	PostHarmonyEffects<SampleType> postHarmonyEffects { state };
+	KernelBuffer subBlockOutput;
 };
 
 }  // namespace Imogen
@@ -2,10 +2,10 @@
 namespace Imogen
 {
 template <typename SampleType>
-Harmonizer<SampleType>::Harmonizer (State& stateToUse, Analyzer& analyzerToUse)
+Harmonizer<SampleType>::Harmonizer (State& stateToUse, Grains& grainsToUse)
 	: dsp::LambdaSynth<SampleType> ([this]
-									{ return new Voice (*this, analyzer); }),
-	  analyzer (analyzerToUse), state (stateToUse)
+									{ return new Voice (*this, grains); }),
+	  grains (grainsToUse), state (stateToUse)
 {
 	this->updateQuickReleaseMs (5);
 
@@ -17,30 +17,333 @@ template <typename SampleType>
 void Harmonizer<SampleType>::prepared (double, int blocksize)
 {
 	wetBuffer.setSize (2, blocksize, true, true, true);
+
+	auto maxGrains = 0;
+
+	for (auto* voice : harmonyVoices)
+	{
+		voice->prepareToPrerender (blocksize);
+		maxGrains += voice->getMaxGrainsPerBlock (blocksize);
+	}
+
+	voiceBatch.reserve (maxGrains);
+
+	voicesToPrerender.ensureStorageAllocated (harmonyVoices.size());
+
+	numVoicesAllowed = internals.numVoices->get();
+
+	allocator.prepare (harmonyVoices.size());
+	allocator.setLimit (numVoicesAllowed);
+
+	pendingVoice = -1;
+
+	for (auto* voice : harmonyVoices)
+		if (voice->isVoiceActive())
+			allocator.claim (voice->index, voice->getCurrentlyPlayingNote());
+
+	// these may be handed a whole sub-block's MIDI, including a full queue of injected notes, and
+	// each event can end one voice's note and start another's
+	segmentMidi.ensureSize (midiBufferBytes + MidiInputQueue::bufferBytes);
+	remainingMidi.ensureSize (midiBufferBytes + MidiInputQueue::bufferBytes);
+	harmonyNoteEvents.ensureSize (2 * (midiBufferBytes + MidiInputQueue::bufferBytes));
+
+	renderPool.prepare (internals.voiceRenderThreads->get(), harmonyVoices.size());
+
+	lastMidiVersion = 0;
 }
 
 template <typename SampleType>
 void Harmonizer<SampleType>::process (int numSamples, MidiBuffer& midiMessages,
 									  bool harmoniesBypassed)
 {
+	harmonyNoteEvents.clear();
+
+	// soundingNotes was cleared, so every note still playing is reported as starting
+	if (std::exchange (reannouncePending, false) && ! harmoniesBypassed)
+		updateSoundingNotes (0);
+
 	if (harmoniesBypassed)
 	{
 		wetBuffer.clear();
 		this->bypassedBlock (numSamples, midiMessages);
+		recordPendingNote();
+
+		// nothing is being rendered, so nothing is reported as playing
+		endSoundingNotes (0, harmonyNoteEvents);
+
+		harmonyIsSilent = true;
+	}
+	else if (grains.isOutputSilent() && midiMessages.isEmpty() && ! anyVoicesActive())
+	{
+		// no voice is sounding and none can start, so there's nothing to render
+		wetBuffer.clear();
+
+		harmonyIsSilent = true;
 	}
 	else
 	{
-		updateParameters();
-		this->renderVoices (midiMessages, wetBuffer);
+		const auto settingsChanged = updateParameters();
+		renderHarmonyVoices (numSamples, midiMessages, settingsChanged);
+
+		// voices can still be sounding, but with nothing to shift they can only output silence
+		harmonyIsSilent = grains.isOutputSilent();
 	}
 
 	updateInternals();
 	lastBlocksize = numSamples;
 }
 
+/* Each sounding voice's pitch shifting up to the block's first MIDI event is done up front, spread
+   across the render pool's threads, and the synth then mixes the prerendered audio into the wet
+   buffer in its usual voice order. Without any worker threads, the grains of all the voices are
+   gathered into one batch and overlap-added in a single pass instead. Each voice's
+   grains are still added in the same order either way, so the output doesn't depend on how many
+   threads are used.
+
+   A voice's pitch can only change at an event or when the MIDI settings change, so the voices
+   render the rest of the block themselves, at the pitch each event leaves them at.
+ */
+template <typename SampleType>
+void Harmonizer<SampleType>::renderHarmonyVoices (int numSamples, MidiBuffer& midiMessages, bool settingsChanged)
+{
+	voicesToPrerender.clearQuick();
+
+	numSamplesToPrerender = midiMessages.isEmpty() ? numSamples : std::min (numSamples, midiMessages.getFirstEventTime());
+
+	const auto canPrerender = numSamplesToPrerender > 0 && ! settingsChanged;
+
+	for (auto* voice : harmonyVoices)
+	{
+		if (canPrerender && voice->canPrerender())
+			voicesToPrerender.add (voice);
+		else
+			voice->discardPrerendered();
+	}
+
+	if (renderPool.getNumWorkers() > 0)
+	{
+		renderPool.perform (voicesToPrerender.size(), &Harmonizer::prerenderVoice, this);
+	}
+	else
+	{
+		voiceBatch.clear();
+
+		for (auto* voice : voicesToPrerender)
+			voice->queuePrerender (numSamplesToPrerender, voiceBatch);
+
+		voiceBatch.process();
+
+		for (auto* voice : voicesToPrerender)
+			voice->finishPrerender (numSamplesToPrerender);
+	}
+
+	// the synth renders as many samples as the buffer it's given holds
+	if (midiMessages.isEmpty())
+	{
+		alias.setDataToReferTo (wetBuffer.getArrayOfWritePointers(), 2, numSamples);
+		this->renderVoices (midiMessages, alias);
+
+		recordPendingNote();
+		return;
+	}
+
+	// rendering is split at each event's timestamp, so that what the voices are playing after each
+	// event can be read, and any changes reported at the sample they happened
+	remainingMidi.clear();
+
+	for (auto start = 0; start < numSamples;)
+	{
+		const auto next = midiMessages.findNextSamplePosition (start + 1);
+		const auto end	= next == midiMessages.cend() ? numSamples : std::min (numSamples, (*next).samplePosition);
+
+		segmentMidi.clear();
+		segmentMidi.addEvents (midiMessages, start, end - start, -start);
+
+		const auto hasEvents = ! segmentMidi.isEmpty();
+
+		alias.setDataToReferTo (wetBuffer.getArrayOfWritePointers(), 2, start, end - start);
+		this->renderVoices (segmentMidi, alias);
+
+		if (hasEvents)
+		{
+			recordPendingNote();
+			updateSoundingNotes (start);
+		}
+
+		remainingMidi.addEvents (segmentMidi, 0, end - start, start);
+
+		start = end;
+	}
+
+	// copied rather than swapped, so that the engine's buffer keeps the capacity it was prepared with
+	midiMessages.clear();
+	midiMessages.addEvents (remainingMidi, 0, -1, 0);
+}
+
+template <typename SampleType>
+void Harmonizer<SampleType>::endSoundingNotes (int samplePosition, MidiBuffer& output)
+{
+	for (auto note = 0; note < 128; ++note)
+		if (soundingNotes[static_cast<size_t> (note)])
+			output.addEvent (juce::MidiMessage::noteOff (MidiState::harmonyOutputChannel, note), samplePosition);
+
+	soundingNotes.reset();
+}
+
+template <typename SampleType>
+void Harmonizer<SampleType>::reannounceSoundingNotes() noexcept
+{
+	soundingNotes.reset();
+	reannouncePending = true;
+}
+
+template <typename SampleType>
+void Harmonizer<SampleType>::updateSoundingNotes (int samplePosition)
+{
+	std::bitset<128> notes;
+
+	allocator.forEachAllocated ([this, &notes] (int index)
+								{
+									const auto* voice = harmonyVoices.getUnchecked (index);
+
+									if (! (voice->isVoiceActive() && voice->isKeyDown()))
+										return;
+
+									const auto note = voice->getCurrentlyPlayingNote();
+
+									if (note >= 0 && note < 128)
+										notes.set (static_cast<size_t> (note));
+								});
+
+	const auto changed = notes ^ soundingNotes;
+
+	if (changed.none())
+		return;
+
+	constexpr auto channel = MidiState::harmonyOutputChannel;
+
+	for (auto note = 0; note < 128; ++note)
+	{
+		const auto index = static_cast<size_t> (note);
+
+		if (! changed[index])
+			continue;
+
+		if (notes[index])
+			harmonyNoteEvents.addEvent (juce::MidiMessage::noteOn (channel, note, static_cast<juce::uint8> (100)), samplePosition);
+		else
+			harmonyNoteEvents.addEvent (juce::MidiMessage::noteOff (channel, note), samplePosition);
+	}
+
+	soundingNotes = notes;
+}
+
+template <typename SampleType>
+void Harmonizer<SampleType>::prerenderVoice (void* harmonizer, int taskIndex)
+{
+	auto& h = *static_cast<Harmonizer*> (harmonizer);
+
+	h.voicesToPrerender.getUnchecked (taskIndex)->prerender (h.numSamplesToPrerender);
+}
+
 template <typename SampleType>
-void Harmonizer<SampleType>::updateParameters()
+bool Harmonizer<SampleType>::anyVoicesActive() const noexcept
 {
+	return pendingVoice >= 0 || allocator.getNumAllocated() > 0;
+}
+
+template <typename SampleType>
+void Harmonizer<SampleType>::voiceCreated (Voice& voice)
+{
+	voice.index = harmonyVoices.size();
+	harmonyVoices.add (&voice);
+}
+
+template <typename SampleType>
+void Harmonizer<SampleType>::voiceDeleted (Voice& voice)
+{
+	harmonyVoices.removeFirstMatchingValue (&voice);
+}
+
+template <typename SampleType>
+void Harmonizer<SampleType>::voiceStopped (Voice& voice)
+{
+	// a stolen voice is stopped as it's given its new note, so it has already been handed out again
+	if (voice.index != pendingVoice)
+		allocator.release (voice.index);
+}
+
+/* All of the voices are allocated up front, so changing the number of voices only changes how
+   many of them new notes can be given to. Voices above the limit that are still sounding when it
+   shrinks are left to finish on their own.
+
+   The synth only starts the note on the voice after this returns, so its note is recorded the next
+   time the allocator is used, or at the end of the block.
+ */
+template <typename SampleType>
+dsp::SynthVoiceBase<SampleType>* Harmonizer<SampleType>::findFreeVoice (bool stealIfNoneAvailable)
+{
+	recordPendingNote();
+
+	const auto index = allocator.allocate (stealIfNoneAvailable);
+
+	if (index < 0)
+		return nullptr;
+
+	pendingVoice = index;
+
+	return harmonyVoices.getUnchecked (index);
+}
+
+template <typename SampleType>
+dsp::SynthVoiceBase<SampleType>* Harmonizer<SampleType>::getVoicePlayingNote (int midiPitch) const
+{
+	const auto isPlaying = [midiPitch] (const Voice* voice)
+	{ return voice->isVoiceActive() && voice->getCurrentlyPlayingNote() == midiPitch; };
+
+	if (pendingVoice >= 0)
+		if (auto* voice = harmonyVoices.getUnchecked (pendingVoice); isPlaying (voice))
+			return voice;
+
+	const auto index = allocator.getVoiceForNote (midiPitch);
+
+	if (index < 0)
+		return nullptr;
+
+	if (auto* voice = harmonyVoices.getUnchecked (index); isPlaying (voice))
+		return voice;
+
+	return nullptr;
+}
+
+template <typename SampleType>
+void Harmonizer<SampleType>::recordPendingNote() noexcept
+{
+	if (pendingVoice < 0)
+		return;
+
+	const auto* voice = harmonyVoices.getUnchecked (pendingVoice);
+
+	if (voice->isVoiceActive())
+		allocator.setNote (pendingVoice, voice->getCurrentlyPlayingNote());
+	else
+		allocator.release (pendingVoice);
+
+	pendingVoice = -1;
+}
+
+template <typename SampleType>
+bool Harmonizer<SampleType>::updateParameters()
+{
+	if (const auto allowed = internals.numVoices->get(); allowed != numVoicesAllowed)
+	{
+		numVoicesAllowed = allowed;
+		allocator.setLimit (allowed);
+	}
+
+	if (! midi.changes.checkForChanges (lastMidiVersion))
+		return false;
+
 	this->setMidiLatch (midi.midiLatch->get());
 
 	this->updateADSRsettings (midi.adsrAttack->get(),
@@ -67,6 +370,8 @@ void Harmonizer<SampleType>::updateParameters()
 
 	this->togglePitchGlide (midi.pitchGlide->get());
 	this->setPitchGlideTime (static_cast<double> (midi.glideTime->get()));
+
+	return true;
 }
 
 template <typename SampleType>
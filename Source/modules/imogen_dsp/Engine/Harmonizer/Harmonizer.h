@@ -4,7 +4,12 @@
 #include <lemons_synth/lemons_synth.h>
 #include <lemons_psola/lemons_psola.h>
 
+#include <bitset>
+
+#include <imogen_dsp/Engine/PSOLA/GrainShifter.h>
 #include "HarmonizerVoice.h"
+#include "VoiceAllocator.h"
+#include "VoiceRenderPool.h"
 
 
 namespace Imogen
@@ -14,11 +19,11 @@ class Harmonizer : public dsp::LambdaSynth<SampleType>
 {
 	using AudioBuffer = juce::AudioBuffer<SampleType>;
 	using Voice		  = HarmonizerVoice<SampleType>;
-	using Analyzer	  = dsp::psola::Analyzer<SampleType>;
+	using Grains	  = GrainCache<SampleType>;
 
 public:
 
-	Harmonizer (State& stateToUse, Analyzer& analyzerToUse);
+	Harmonizer (State& stateToUse, Grains& grainsToUse);
 
 	void process (int		  numSamples,
 				  MidiBuffer& midiMessages,
@@ -26,15 +31,57 @@ public:
 
 	AudioBuffer& getHarmonySignal();
 
-	Analyzer& analyzer;
+	/* True if the harmony signal for the last block was silent. */
+	bool isHarmonySignalSilent() const noexcept { return harmonyIsSilent; }
+
+	/* Note ons and offs on the harmony output channel for every note the voices started or stopped
+	   playing during the last block, at the sample each one happened. A note counts as playing from
+	   when a voice is given it until its key is released.
+	 */
+	const MidiBuffer& getHarmonyNoteEvents() const noexcept { return harmonyNoteEvents; }
+
+	/* Adds a note off for every note reported as playing, and forgets them, for when the MIDI output
+	   is turned off or the harmonizer is bypassed.
+	 */
+	void endSoundingNotes (int samplePosition, MidiBuffer& output);
+
+	/* Makes the next block report every note the voices are playing as starting, for when the MIDI
+	   output is turned back on.
+	 */
+	void reannounceSoundingNotes() noexcept;
+
+	/* The voices are resynthesized from the grain cache, so they add nothing to the cache's own latency. */
+	int getLatencySamples() const noexcept { return 0; }
+
+	Grains& grains;
 
 private:
 
+	friend Voice;
+
 	void prepared (double samplerate, int blocksize) final;
 
-	void updateParameters();
+	/* Returns true if the MIDI settings changed, which can change the pitch of voices already playing. */
+	bool updateParameters();
 	void updateInternals();
 
+	void renderHarmonyVoices (int numSamples, MidiBuffer& midiMessages, bool settingsChanged);
+
+	void updateSoundingNotes (int samplePosition);
+
+	bool anyVoicesActive() const noexcept;
+
+	dsp::SynthVoiceBase<SampleType>* findFreeVoice (bool stealIfNoneAvailable) final;
+	dsp::SynthVoiceBase<SampleType>* getVoicePlayingNote (int midiPitch) const final;
+
+	void recordPendingNote() noexcept;
+
+	static void prerenderVoice (void* harmonizer, int taskIndex);
+
+	void voiceCreated (Voice& voice);
+	void voiceDeleted (Voice& voice);
+	void voiceStopped (Voice& voice);
+
 	State&		state;
 	Parameters& parameters { state.parameters };
 	MidiState&	midi { parameters.midiState };
@@ -44,6 +91,34 @@ private:
 	AudioBuffer alias;
 
 	int lastBlocksize { 0 };
+
+	bool harmonyIsSilent { false };
+
+	juce::Array<Voice*> harmonyVoices, voicesToPrerender;
+
+	int numSamplesToPrerender { 0 };
+
+	GrainBatch<SampleType> voiceBatch;
+
+	juce::uint32 lastMidiVersion { 0 };
+
+	int numVoicesAllowed { 0 };
+
+	VoiceAllocator allocator;
+
+	// the voice most recently given out, whose note is recorded once the synth has started it
+	int pendingVoice { -1 };
+
+	// the block's events from one timestamp to the next, and the events the synth has left so far
+	MidiBuffer segmentMidi, remainingMidi;
+
+	MidiBuffer		 harmonyNoteEvents;
+	std::bitset<128> soundingNotes;
+	bool			 reannouncePending { false };
+
+	static constexpr auto midiBufferBytes = 4096;
+
+	VoiceRenderPool renderPool;
 };
 
 
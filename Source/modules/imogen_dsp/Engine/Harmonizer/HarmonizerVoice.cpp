@@ -2,18 +2,111 @@
 namespace Imogen
 {
 template <typename SampleType>
-HarmonizerVoice<SampleType>::HarmonizerVoice (Harmonizer<SampleType>& h, dsp::psola::Analyzer<SampleType>& analyzerToUse)
-	: dsp::SynthVoiceBase<SampleType> (&h), shifter (analyzerToUse)
+HarmonizerVoice<SampleType>::HarmonizerVoice (Harmonizer<SampleType>& h, const GrainCache<SampleType>& grains)
+	: dsp::SynthVoiceBase<SampleType> (&h), harmonizer (h), shifter (grains)
 {
+	harmonizer.voiceCreated (*this);
 }
 
 template <typename SampleType>
-void HarmonizerVoice<SampleType>::renderPlease (AudioBuffer& output, float desiredFrequency, double currentSamplerate)
+HarmonizerVoice<SampleType>::~HarmonizerVoice()
 {
-	jassert (desiredFrequency > 0 && currentSamplerate > 0);
+	harmonizer.voiceDeleted (*this);
+}
+
+template <typename SampleType>
+void HarmonizerVoice<SampleType>::renderPlease (AudioBuffer& output, float desiredFrequency, double)
+{
+	jassert (desiredFrequency > 0);
+
+	pitchIsSteady = desiredFrequency == lastFrequency;
+	lastFrequency = desiredFrequency;
+
+	// the audio was rendered at the old pitch, so the shifter starts again from this block
+	if (readPosition < numPrerendered && desiredFrequency != prerenderedFrequency)
+		discardPrerendered();
+
+	const auto numSamples		= output.getNumSamples();
+	const auto numFromPrerender = std::min (numSamples, numPrerendered - readPosition);
+
+	for (auto chan = 0; chan < output.getNumChannels(); ++chan)
+		output.copyFrom (chan, 0, prerendered, 0, readPosition, numFromPrerender);
+
+	readPosition += numFromPrerender;
+
+	if (numFromPrerender == numSamples)
+		return;
+
+	// the shifter carries on from where the prerendered audio ended
+	shifter.setPitch (desiredFrequency);
+	shifter.getSamples (output.getWritePointer (0, numFromPrerender), numSamples - numFromPrerender);
+
+	for (auto chan = 1; chan < output.getNumChannels(); ++chan)
+		output.copyFrom (chan, numFromPrerender, output, 0, numFromPrerender, numSamples - numFromPrerender);
+}
+
+template <typename SampleType>
+void HarmonizerVoice<SampleType>::noteCleared()
+{
+	discardPrerendered();
+
+	// a restarted voice may glide in from wherever it was, so it isn't prerendered until it settles
+	lastFrequency = 0.f;
+
+	harmonizer.voiceStopped (*this);
+}
+
+template <typename SampleType>
+void HarmonizerVoice<SampleType>::prepareToPrerender (int blocksize)
+{
+	prerendered.setSize (1, blocksize, true, true, true);
+	shifter.prepare (blocksize);
+	discardPrerendered();
+}
 
-	shifter.setPitch (desiredFrequency, currentSamplerate);
-	shifter.getSamples (output);
+template <typename SampleType>
+bool HarmonizerVoice<SampleType>::canPrerender() const noexcept
+{
+	return this->isVoiceActive() && lastFrequency > 0.f && pitchIsSteady;
+}
+
+template <typename SampleType>
+void HarmonizerVoice<SampleType>::prerender (int numSamples)
+{
+	jassert (numSamples <= prerendered.getNumSamples());
+
+	shifter.setPitch (lastFrequency);
+	shifter.getSamples (prerendered.getWritePointer (0), numSamples);
+
+	numPrerendered		 = numSamples;
+	readPosition		 = 0;
+	prerenderedFrequency = lastFrequency;
+}
+
+template <typename SampleType>
+void HarmonizerVoice<SampleType>::queuePrerender (int numSamples, GrainBatch<SampleType>& batch)
+{
+	jassert (numSamples <= prerendered.getNumSamples());
+
+	shifter.setPitch (lastFrequency);
+	shifter.queueGrains (numSamples, batch);
+}
+
+template <typename SampleType>
+void HarmonizerVoice<SampleType>::finishPrerender (int numSamples) noexcept
+{
+	shifter.readSamples (prerendered.getWritePointer (0), numSamples);
+
+	numPrerendered		 = numSamples;
+	readPosition		 = 0;
+	prerenderedFrequency = lastFrequency;
+}
+
+template <typename SampleType>
+void HarmonizerVoice<SampleType>::discardPrerendered() noexcept
+{
+	numPrerendered = 0;
+	readPosition   = 0;
 }
 
 template class HarmonizerVoice<float>;
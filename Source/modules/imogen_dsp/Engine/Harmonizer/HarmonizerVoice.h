@@ -17,13 +17,53 @@ class HarmonizerVoice : public dsp::SynthVoiceBase<SampleType>
 
 public:
 
-	HarmonizerVoice (Harmonizer<SampleType>& h, dsp::psola::Analyzer<SampleType>& analyzerToUse);
+	HarmonizerVoice (Harmonizer<SampleType>& h, const GrainCache<SampleType>& grains);
+
+	~HarmonizerVoice() override;
+
+	void prepareToPrerender (int blocksize);
+
+	/* True if this voice can render ahead before the synth asks for it: it's playing, and its pitch
+	   was the same the last two times it was rendered, so it won't change before the next MIDI event.
+	 */
+	bool canPrerender() const noexcept;
+
+	/* Renders the next numSamples of shifted audio at the pitch the voice was last rendered at.
+	   This touches only this voice's own state, so different voices may be prerendered concurrently.
+	   If the synth then asks for a different pitch, whatever is left of it is thrown away.
+	 */
+	void prerender (int numSamples);
+
+	/* The same as prerender(), but split around one overlap-add pass over a batch shared with
+	   other voices.
+	 */
+	void queuePrerender (int numSamples, GrainBatch<SampleType>& batch);
+	void finishPrerender (int numSamples) noexcept;
+
+	int getMaxGrainsPerBlock (int blocksize) const noexcept { return shifter.getMaxGrainsPerBlock (blocksize); }
+
+	void discardPrerendered() noexcept;
+
+	// this voice's position in the harmonizer's pool
+	int index { -1 };
 
 private:
 
 	void renderPlease (AudioBuffer& output, float desiredFrequency, double currentSamplerate) final;
+	void noteCleared() final;
+
+	Harmonizer<SampleType>& harmonizer;
+
+	GrainShifter<SampleType> shifter;
+
+	AudioBuffer prerendered;
+
+	int numPrerendered { 0 }, readPosition { 0 };
+
+	float lastFrequency { 0.f }, prerenderedFrequency { 0.f };
 
-	dsp::psola::Shifter<SampleType> shifter;
+	// false while the pitch is moving, as it does while gliding
+	bool pitchIsSteady { false };
 };
 
 
@@ -0,0 +1,171 @@
+
+namespace Imogen
+{
+void VoiceAllocator::prepare (int numVoices)
+{
+	nodes.assign (static_cast<size_t> (numVoices), {});
+
+	voiceForNote.fill (-1);
+
+	oldest		 = -1;
+	newest		 = -1;
+	numAllocated = 0;
+
+	setLimit (numVoices);
+}
+
+/* Rebuilding the free list is linear, but the limit only changes when the number of voices does. */
+void VoiceAllocator::setLimit (int maxVoices)
+{
+	limit = juce::jlimit (0, static_cast<int> (nodes.size()), maxVoices);
+
+	firstFree = -1;
+
+	// built backwards so that the lowest voices are given out first
+	for (auto voice = limit - 1; voice >= 0; --voice)
+	{
+		auto& node = nodes[static_cast<size_t> (voice)];
+
+		if (node.allocated)
+			continue;
+
+		node.next = firstFree;
+		firstFree = voice;
+	}
+}
+
+int VoiceAllocator::allocate (bool stealIfNoneFree) noexcept
+{
+	if (firstFree >= 0)
+	{
+		const auto voice = firstFree;
+		auto&	   node	 = nodes[static_cast<size_t> (voice)];
+
+		firstFree = node.next;
+
+		node.allocated = true;
+		++numAllocated;
+
+		append (voice);
+		return voice;
+	}
+
+	if (! stealIfNoneFree || oldest < 0)
+		return -1;
+
+	const auto voice = oldest;
+
+	clearNote (voice);
+	unlink (voice);
+	append (voice);
+
+	return voice;
+}
+
+void VoiceAllocator::claim (int voice, int midiNote)
+{
+	auto& node = nodes[static_cast<size_t> (voice)];
+
+	if (node.allocated)
+		return;
+
+	node.allocated = true;
+	++numAllocated;
+
+	append (voice);
+	setNote (voice, midiNote);
+
+	setLimit (limit);
+}
+
+void VoiceAllocator::setNote (int voice, int midiNote) noexcept
+{
+	jassert (nodes[static_cast<size_t> (voice)].allocated);
+
+	clearNote (voice);
+
+	if (midiNote < 0 || midiNote > 127)
+		return;
+
+	nodes[static_cast<size_t> (voice)].note = midiNote;
+	voiceForNote[static_cast<size_t> (midiNote)] = voice;
+}
+
+void VoiceAllocator::release (int voice) noexcept
+{
+	auto& node = nodes[static_cast<size_t> (voice)];
+
+	if (! node.allocated)
+		return;
+
+	clearNote (voice);
+	unlink (voice);
+
+	node.allocated = false;
+	--numAllocated;
+
+	// a voice above the limit is only put back once the limit is raised again
+	if (voice < limit)
+	{
+		node.next = firstFree;
+		firstFree = voice;
+	}
+}
+
+int VoiceAllocator::getVoiceForNote (int midiNote) const noexcept
+{
+	if (midiNote < 0 || midiNote > 127)
+		return -1;
+
+	return voiceForNote[static_cast<size_t> (midiNote)];
+}
+
+void VoiceAllocator::clearNote (int voice) noexcept
+{
+	auto& node = nodes[static_cast<size_t> (voice)];
+
+	if (node.note < 0)
+		return;
+
+	auto& entry = voiceForNote[static_cast<size_t> (node.note)];
+
+	if (entry == voice)
+		entry = -1;
+
+	node.note = -1;
+}
+
+void VoiceAllocator::unlink (int voice) noexcept
+{
+	auto& node = nodes[static_cast<size_t> (voice)];
+
+	if (node.previous >= 0)
+		nodes[static_cast<size_t> (node.previous)].next = node.next;
+	else
+		oldest = node.next;
+
+	if (node.next >= 0)
+		nodes[static_cast<size_t> (node.next)].previous = node.previous;
+	else
+		newest = node.previous;
+
+	node.previous = -1;
+	node.next	  = -1;
+}
+
+void VoiceAllocator::append (int voice) noexcept
+{
+	auto& node = nodes[static_cast<size_t> (voice)];
+
+	node.previous = newest;
+	node.next	  = -1;
+
+	if (newest >= 0)
+		nodes[static_cast<size_t> (newest)].next = voice;
+	else
+		oldest = voice;
+
+	newest = voice;
+}
+
+}  // namespace Imogen
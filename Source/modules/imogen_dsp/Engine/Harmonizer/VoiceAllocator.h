@@ -0,0 +1,80 @@
+#pragma once
+
+namespace Imogen
+{
+/* Keeps track of which of a fixed pool of voices are free, which note each voice is playing and
+   the order the voices were started in, so that finding a voice for a note, finding a free voice
+   and finding the oldest voice to steal all take constant time however many voices there are.
+
+   Voices are referred to by their index in the pool. The free voices are kept in a list, and the
+   others in a list ordered from the oldest to the newest, threaded through the same nodes.
+ */
+class VoiceAllocator
+{
+public:
+
+	void prepare (int numVoices);
+
+	/* Only voices below this index are given out. Voices above it that are still sounding are left
+	   to finish, but can still be stolen.
+	 */
+	void setLimit (int maxVoices);
+
+	/* Returns the index of a free voice, or if there are none and stealIfNoneFree is true, of the
+	   oldest voice. Returns -1 if there is no voice to give. The voice becomes the newest.
+	 */
+	int allocate (bool stealIfNoneFree) noexcept;
+
+	/* Marks a voice that is already sounding as allocated, as if it had just been given the note.
+	   This is linear in the number of voices, so is only meant for after the allocator is prepared.
+	 */
+	void claim (int voice, int midiNote);
+
+	/* Records the note a voice has started; the voice must have just been allocated. */
+	void setNote (int voice, int midiNote) noexcept;
+
+	/* Called when a voice has finished sounding. */
+	void release (int voice) noexcept;
+
+	/* The voice last given this note, or -1 if none has been, or it has since been freed or stolen. */
+	int getVoiceForNote (int midiNote) const noexcept;
+
+	int getOldestVoice() const noexcept { return oldest; }
+
+	/* Calls the callback with the index of every allocated voice, from the oldest to the newest. */
+	template <typename Callback>
+	void forEachAllocated (Callback&& callback) const
+	{
+		for (auto voice = oldest; voice >= 0; voice = nodes[static_cast<size_t> (voice)].next)
+			callback (voice);
+	}
+
+	int getNumAllocated() const noexcept { return numAllocated; }
+
+private:
+
+	struct Node
+	{
+		int previous { -1 }, next { -1 };
+
+		int note { -1 };
+
+		bool allocated { false };
+	};
+
+	void unlink (int voice) noexcept;
+	void append (int voice) noexcept;
+
+	void clearNote (int voice) noexcept;
+
+	std::vector<Node> nodes;
+
+	// next is used as the link for both lists, as a voice is only ever in one of them
+	int firstFree { -1 }, oldest { -1 }, newest { -1 };
+
+	int limit { 0 }, numAllocated { 0 };
+
+	std::array<int, 128> voiceForNote;
+};
+
+}  // namespace Imogen
@@ -0,0 +1,157 @@
+
+namespace Imogen
+{
+VoiceRenderPool::~VoiceRenderPool()
+{
+	release();
+}
+
+void VoiceRenderPool::prepare (int numWorkers, int maxNumTasks)
+{
+	jassert (maxNumTasks < 0xffff);
+
+	release();
+
+	queues.clear();
+
+	for (auto i = 0; i <= numWorkers; ++i)
+	{
+		auto queue = std::make_unique<Queue>();
+		queue->tasks.resize (static_cast<size_t> (maxNumTasks));
+		queues.push_back (std::move (queue));
+	}
+
+	for (auto i = 1; i <= numWorkers; ++i)
+		workers.add (new Worker (*this, i))->startThread (juce::Thread::realtimeAudioPriority);
+}
+
+void VoiceRenderPool::release()
+{
+	for (auto* worker : workers)
+		worker->signalThreadShouldExit();
+
+	generation.fetch_add (1, std::memory_order_release);
+	generation.notify_all();
+
+	for (auto* worker : workers)
+		worker->stopThread (1000);
+
+	workers.clear();
+}
+
+void VoiceRenderPool::perform (int numTasks, Job job, void* context) noexcept
+{
+	if (numTasks <= 0)
+		return;
+
+	if (workers.isEmpty())
+	{
+		for (auto i = 0; i < numTasks; ++i)
+			job (context, i);
+
+		return;
+	}
+
+	const auto numQueues = static_cast<int> (queues.size());
+	const auto newGen	 = generation.load (std::memory_order_relaxed) + 1;
+
+	for (auto q = 0; q < numQueues; ++q)
+	{
+		auto& queue = *queues[static_cast<size_t> (q)];
+
+		auto end = 0;
+
+		for (auto task = q; task < numTasks; task += numQueues)
+			queue.tasks[static_cast<size_t> (end++)] = task;
+
+		queue.state.store (Queue::pack (newGen, end, 0), std::memory_order_release);
+	}
+
+	currentJob	   = job;
+	currentContext = context;
+	tasksRemaining.store (numTasks, std::memory_order_relaxed);
+
+	generation.store (newGen, std::memory_order_release);
+	generation.notify_all();
+
+	drain (0, newGen);
+
+	while (tasksRemaining.load (std::memory_order_acquire) > 0)
+		std::this_thread::yield();
+}
+
+void VoiceRenderPool::drain (int ownQueue, juce::uint32 gen) noexcept
+{
+	auto& mine = *queues[static_cast<size_t> (ownQueue)];
+
+	while (runNextTask (mine, gen))
+	{
+	}
+
+	const auto numQueues = static_cast<int> (queues.size());
+
+	for (auto offset = 1; offset < numQueues; ++offset)
+	{
+		auto& victim = *queues[static_cast<size_t> ((ownQueue + offset) % numQueues)];
+
+		while (runNextTask (victim, gen))
+		{
+		}
+	}
+}
+
+bool VoiceRenderPool::runNextTask (Queue& queue, juce::uint32 gen) noexcept
+{
+	auto state = queue.state.load (std::memory_order_acquire);
+
+	while (true)
+	{
+		const auto stateGen = static_cast<juce::uint32> (state >> 32);
+		const auto end		= static_cast<int> ((state >> 16) & 0xffff);
+		const auto next		= static_cast<int> (state & 0xffff);
+
+		if (stateGen != gen || next >= end)
+			return false;
+
+		if (queue.state.compare_exchange_weak (state, Queue::pack (gen, end, next + 1),
+											   std::memory_order_acq_rel, std::memory_order_acquire))
+		{
+			currentJob (currentContext, queue.tasks[static_cast<size_t> (next)]);
+			tasksRemaining.fetch_sub (1, std::memory_order_acq_rel);
+			return true;
+		}
+	}
+}
+
+juce::uint64 VoiceRenderPool::Queue::pack (juce::uint32 gen, int end, int next) noexcept
+{
+	return (static_cast<juce::uint64> (gen) << 32)
+		 | (static_cast<juce::uint64> (end & 0xffff) << 16)
+		 | static_cast<juce::uint64> (next & 0xffff);
+}
+
+/*------------------------------------------------------------------------------------------*/
+
+VoiceRenderPool::Worker::Worker (VoiceRenderPool& poolToUse, int queueIndexToUse)
+	: juce::Thread ("Imogen voice renderer " + String (queueIndexToUse)), pool (poolToUse), queueIndex (queueIndexToUse)
+{
+}
+
+void VoiceRenderPool::Worker::run()
+{
+	auto seen = pool.generation.load (std::memory_order_acquire);
+
+	while (! threadShouldExit())
+	{
+		pool.generation.wait (seen, std::memory_order_acquire);
+
+		seen = pool.generation.load (std::memory_order_acquire);
+
+		if (threadShouldExit())
+			return;
+
+		pool.drain (queueIndex, seen);
+	}
+}
+
+}  // namespace Imogen
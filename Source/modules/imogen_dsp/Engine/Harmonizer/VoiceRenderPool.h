@@ -0,0 +1,66 @@
+#pragma once
+
+namespace Imogen
+{
+/* A small pool of pre-spawned real-time threads that the audio thread can hand a batch of
+   independent tasks to. Tasks are dealt out round-robin to one queue per participant (the
+   audio thread is participant 0); anyone who runs out of work steals from the other queues.
+ */
+class VoiceRenderPool
+{
+public:
+
+	using Job = void (*) (void* context, int taskIndex);
+
+	VoiceRenderPool() = default;
+
+	~VoiceRenderPool();
+
+	/* Spawns the worker threads. Must not be called from the audio thread. */
+	void prepare (int numWorkers, int maxNumTasks);
+
+	void release();
+
+	int getNumWorkers() const noexcept { return workers.size(); }
+
+	/* Runs job for every task index in [0, numTasks) and returns once they have all finished.
+	   With no workers, the tasks are simply run in order on the calling thread.
+	 */
+	void perform (int numTasks, Job job, void* context) noexcept;
+
+private:
+
+	// the generation, end and next indices are packed into one word so that a worker still
+	// holding on to an old generation can never claim a task from a newer one
+	struct alignas (64) Queue
+	{
+		static juce::uint64 pack (juce::uint32 gen, int end, int next) noexcept;
+
+		std::vector<int>		  tasks;
+		std::atomic<juce::uint64> state { 0 };
+	};
+
+	struct Worker : juce::Thread
+	{
+		Worker (VoiceRenderPool& poolToUse, int queueIndexToUse);
+
+		void run() final;
+
+		VoiceRenderPool& pool;
+		const int		 queueIndex;
+	};
+
+	void drain (int ownQueue, juce::uint32 gen) noexcept;
+	bool runNextTask (Queue& queue, juce::uint32 gen) noexcept;
+
+	std::vector<std::unique_ptr<Queue>> queues;
+	juce::OwnedArray<Worker>			workers;
+
+	Job	  currentJob { nullptr };
+	void* currentContext { nullptr };
+
+	std::atomic<juce::uint32> generation { 0 };
+	std::atomic<int>		  tasksRemaining { 0 };
+};
+
+}  // namespace Imogen
@@ -3,7 +3,7 @@ namespace Imogen
 {
 template <typename SampleType>
 LeadProcessor<SampleType>::LeadProcessor (Harmonizer<SampleType>& harm, State& stateToUse)
-	: pitchCorrector (harm, stateToUse.internals), dryPanner (stateToUse.parameters)
+	: grains (harm.grains), pitchCorrector (harm), dryPanner (stateToUse.parameters)
 {
 }
 
@@ -19,9 +19,23 @@ void LeadProcessor<SampleType>::prepare (double samplerate, int blocksize)
 template <typename SampleType>
 void LeadProcessor<SampleType>::process (bool leadIsBypassed, int numSamples)
 {
-	pitchCorrector.renderNextFrame (numSamples);
-	dryPanner.process (pitchCorrector.getCorrectedSignal(), pannedLeadBuffer, leadIsBypassed);
 	lastBlocksize = numSamples;
+
+	auto& output = getProcessedSignal();
+
+	// the corrector's shifter picks up again at the right place by itself once it's next asked for samples
+	if (grains.isOutputSilent())
+	{
+		output.clear();
+
+		leadIsSilent = true;
+		return;
+	}
+
+	pitchCorrector.renderNextFrame (numSamples);
+	dryPanner.process (pitchCorrector.getCorrectedSignal(), output, leadIsBypassed);
+
+	leadIsSilent = leadIsBypassed;
 }
 
 template <typename SampleType>
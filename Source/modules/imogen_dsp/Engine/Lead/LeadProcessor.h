@@ -3,6 +3,7 @@
 
 #include "PitchCorrector.h"
 #include "DryPanner.h"
+#include "PitchToMidi.h"
 
 namespace Imogen
 {
@@ -12,7 +13,6 @@ class LeadProcessor
 public:
 
 	using AudioBuffer = juce::AudioBuffer<SampleType>;
-	using Analyzer	  = dsp::psola::Analyzer<SampleType>;
 	using Synth		  = dsp::SynthBase<SampleType>;
 
 	LeadProcessor (Harmonizer<SampleType>& harm, State& stateToUse);
@@ -23,8 +23,16 @@ public:
 
 	AudioBuffer& getProcessedSignal();
 
+	/* True if the lead signal for the last block was silent. */
+	bool isProcessedSignalSilent() const noexcept { return leadIsSilent; }
+
+	/* The lead is resynthesized from the grain cache, so it adds nothing to the cache's own latency. */
+	int getLatencySamples() const noexcept { return 0; }
+
 private:
 
+	const GrainCache<SampleType>& grains;
+
 	PitchCorrection<SampleType> pitchCorrector;
 	DryPanner<SampleType>		dryPanner;
 
@@ -32,6 +40,8 @@ private:
 	AudioBuffer alias;
 
 	int lastBlocksize { 0 };
+
+	bool leadIsSilent { false };
 };
 
 }  // namespace Imogen
@@ -2,8 +2,8 @@
 namespace Imogen
 {
 template <typename SampleType>
-PitchCorrection<SampleType>::PitchCorrection (Harmonizer<SampleType>& harm, Internals& internalsToUse)
-	: Base (harm.analyzer, harm.getPitchAdjuster()), internals (internalsToUse)
+PitchCorrection<SampleType>::PitchCorrection (Harmonizer<SampleType>& harm)
+	: shifter (harm.grains), grains (harm.grains), harmonizer (harm)
 {
 }
 
@@ -12,10 +12,22 @@ void PitchCorrection<SampleType>::renderNextFrame (int numSamples)
 {
 	alias.setDataToReferTo (correctedBuffer.getArrayOfWritePointers(), 1, numSamples);
 
-	this->processNextFrame (alias);
+	const auto inputFreq = grains.getInputFrequency();
 
-	internals.currentInputNote->set (this->getOutputMidiPitch());
-	internals.currentCentsSharp->set (this->getCentsSharp());
+	if (inputFreq > 0.f)
+	{
+		const auto* pitch = harmonizer.getPitchAdjuster();
+
+		const auto note = juce::roundToInt (pitch->getMidiForFrequency (inputFreq));
+
+		shifter.setPitch (pitch->getFrequencyForMidi (note));
+	}
+	else
+	{
+		shifter.setPitch (0.f);
+	}
+
+	shifter.getSamples (alias);
 }
 
 template <typename SampleType>
@@ -25,10 +37,10 @@ const juce::AudioBuffer<SampleType>& PitchCorrection<SampleType>::getCorrectedSi
 }
 
 template <typename SampleType>
-void PitchCorrection<SampleType>::prepare (double samplerate, int blocksize)
+void PitchCorrection<SampleType>::prepare (double, int blocksize)
 {
 	correctedBuffer.setSize (1, blocksize, true, true, true);
-	Base::prepare (samplerate);
+	shifter.prepare (blocksize);
 }
 
 template class PitchCorrection<float>;
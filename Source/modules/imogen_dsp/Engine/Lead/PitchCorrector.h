@@ -5,14 +5,13 @@
 namespace Imogen
 {
 template <typename SampleType>
-class PitchCorrection : public dsp::psola::PitchCorrectorBase<SampleType>
+class PitchCorrection
 {
 public:
 
 	using AudioBuffer = juce::AudioBuffer<SampleType>;
-	using Base		  = dsp::psola::PitchCorrectorBase<SampleType>;
 
-	PitchCorrection (Harmonizer<SampleType>& harm, Internals& internalsToUse);
+	explicit PitchCorrection (Harmonizer<SampleType>& harm);
 
 	void renderNextFrame (int numSamples);
 
@@ -22,7 +21,12 @@ public:
 
 private:
 
-	Internals& internals;
+	GrainShifter<SampleType> shifter;
+
+	const GrainCache<SampleType>& grains;
+
+	// the harmonizer's scale, tuning and pitch bend, which the lead is corrected to as well
+	Harmonizer<SampleType>& harmonizer;
 
 	AudioBuffer correctedBuffer;
 	AudioBuffer alias;
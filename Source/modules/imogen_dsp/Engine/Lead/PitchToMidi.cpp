@@ -0,0 +1,60 @@
+
+namespace Imogen
+{
+void PitchToMidi::process (float frequency, int samplePosition, MidiBuffer& output)
+{
+	if (frequency <= 0.f)
+	{
+		if (currentNote >= 0)
+			output.addEvent (juce::MidiMessage::noteOff (channel, currentNote), samplePosition);
+
+		currentNote = -1;
+		return;
+	}
+
+	const auto pitch = 69.f + 12.f * std::log2 (frequency / 440.f);
+
+	if (pitch < 0.f || pitch > 127.f)
+		return;
+
+	const auto noteChanges = currentNote < 0 || std::abs (pitch - static_cast<float> (currentNote)) > 0.5f + hysteresisSemitones;
+
+	const auto note = noteChanges ? juce::roundToInt (pitch) : currentNote;
+
+	const auto bend = juce::jlimit (0, 16383, 8192 + juce::roundToInt ((pitch - static_cast<float> (note)) / bendRangeSemitones * 8192.f));
+
+	if (noteChanges && currentNote >= 0)
+		output.addEvent (juce::MidiMessage::noteOff (channel, currentNote), samplePosition);
+
+	// the bend goes first, so that the new note starts in tune
+	if (bend != currentBend)
+	{
+		output.addEvent (juce::MidiMessage::pitchWheel (channel, bend), samplePosition);
+		currentBend = bend;
+	}
+
+	if (noteChanges)
+	{
+		output.addEvent (juce::MidiMessage::noteOn (channel, note, velocity), samplePosition);
+		currentNote = note;
+	}
+}
+
+void PitchToMidi::stop (int samplePosition, MidiBuffer& output)
+{
+	if (currentNote >= 0)
+		output.addEvent (juce::MidiMessage::noteOff (channel, currentNote), samplePosition);
+
+	if (currentBend != 8192)
+		output.addEvent (juce::MidiMessage::pitchWheel (channel, 8192), samplePosition);
+
+	reset();
+}
+
+void PitchToMidi::reset() noexcept
+{
+	currentNote = -1;
+	currentBend = 8192;
+}
+
+}  // namespace Imogen
@@ -0,0 +1,36 @@
+#pragma once
+
+namespace Imogen
+{
+/* Turns the lead's detected pitch into MIDI: a note for the nearest semitone, with pitch bend for
+   the rest. The note only changes once the pitch has moved some way past the next semitone, so
+   that vibrato or a wobbly note around the midpoint doesn't retrigger it every estimate.
+ */
+class PitchToMidi
+{
+public:
+
+	/* A frequency of 0 means the lead is unpitched, which ends the current note. */
+	void process (float frequency, int samplePosition, MidiBuffer& output);
+
+	/* Ends the lead's note, for when the output is turned off. The harmonizer ends its own notes. */
+	void stop (int samplePosition, MidiBuffer& output);
+
+	static constexpr auto channel = MidiState::leadOutputChannel;
+
+	// the receiving synth is assumed to use the usual pitch bend range
+	static constexpr auto bendRangeSemitones = 2.f;
+
+private:
+
+	void reset() noexcept;
+
+	int currentNote { -1 }, currentBend { 8192 };
+
+	// how far past the midpoint to the next semitone the pitch has to go to change the note
+	static constexpr auto hysteresisSemitones = 0.25f;
+
+	static constexpr auto velocity = static_cast<juce::uint8> (100);
+};
+
+}  // namespace Imogen
@@ -0,0 +1,59 @@
+
+namespace Imogen
+{
+template <typename SampleType>
+void measureLevels (const SampleType* const* channels, int numChannels, int numSamples,
+					float* peaks, float* rmsLevels) noexcept
+{
+	using Lanes = Lanes4<SampleType>;
+
+	jassert (numChannels <= maxMeasuredChannels);
+
+	std::array<Lanes, maxMeasuredChannels> peakLanes, sumLanes;
+
+	peakLanes.fill (Lanes::broadcast (SampleType (0)));
+	sumLanes.fill (Lanes::broadcast (SampleType (0)));
+
+	const auto numVectorised = numSamples - numSamples % 4;
+
+	for (auto i = 0; i < numVectorised; i += 4)
+	{
+		for (auto chan = 0; chan < numChannels; ++chan)
+		{
+			const auto c	   = static_cast<size_t> (chan);
+			const auto samples = Lanes::load (channels[chan] + i);
+
+			peakLanes[c] = max (peakLanes[c], abs (samples));
+			sumLanes[c]	 = sumLanes[c] + samples * samples;
+		}
+	}
+
+	for (auto chan = 0; chan < numChannels; ++chan)
+	{
+		const auto c = static_cast<size_t> (chan);
+
+		std::array<SampleType, 4> peak, sum;
+
+		peakLanes[c].store (peak.data());
+		sumLanes[c].store (sum.data());
+
+		auto channelPeak = *std::max_element (peak.begin(), peak.end());
+		auto channelSum	 = std::accumulate (sum.begin(), sum.end(), SampleType (0));
+
+		for (auto i = numVectorised; i < numSamples; ++i)
+		{
+			const auto sample = channels[chan][i];
+
+			channelPeak = std::max (channelPeak, std::abs (sample));
+			channelSum += sample * sample;
+		}
+
+		peaks[chan]		= static_cast<float> (channelPeak);
+		rmsLevels[chan] = numSamples > 0 ? static_cast<float> (std::sqrt (channelSum / static_cast<SampleType> (numSamples))) : 0.f;
+	}
+}
+
+template void measureLevels (const float* const*, int, int, float*, float*) noexcept;
+template void measureLevels (const double* const*, int, int, float*, float*) noexcept;
+
+}  // namespace Imogen
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <imogen_dsp/Engine/SIMD.h>
+
+namespace Imogen
+{
+/* Measures the peak and RMS level of several channels of the same length at once. Every channel is
+   read in one pass, four samples at a time, and the peak and the sum of squares are kept side by
+   side, so no sample is loaded more than once whatever is being measured.
+ */
+template <typename SampleType>
+void measureLevels (const SampleType* const* channels, int numChannels, int numSamples,
+					float* peaks, float* rmsLevels) noexcept;
+
+static constexpr auto maxMeasuredChannels = 4;
+
+}  // namespace Imogen
@@ -0,0 +1,249 @@
+
+namespace Imogen
+{
+template <typename SampleType>
+GrainCache<SampleType>::GrainCache (float minInputFreqHz)
+	: minFreq (minInputFreqHz)
+{
+	jassert (minFreq > 0.f && minFreq < maxInputFreq);
+}
+
+template <typename SampleType>
+void GrainCache<SampleType>::setMinInputFrequency (float minInputFreqHz)
+{
+	jassert (minInputFreqHz > 0.f && minInputFreqHz < maxInputFreq);
+
+	minFreq = minInputFreqHz;
+}
+
+template <typename SampleType>
+void GrainCache<SampleType>::prepare (double newSamplerate, int blocksize)
+{
+	jassert (newSamplerate > 0. && blocksize > 0);
+
+	samplerate = newSamplerate;
+	minPeriod  = std::max (2, static_cast<int> (samplerate / maxInputFreq));
+	maxPeriod  = static_cast<int> (std::ceil (samplerate / minFreq));
+
+	// synthesis places grains up to one period past the end of the output block,
+	// and the newest grain is only complete one period before the end of the input
+	latency = 2 * maxPeriod;
+
+	history.assign (static_cast<size_t> (juce::nextPowerOfTwo (4 * maxPeriod + blocksize)), SampleType (0));
+	historyMask = static_cast<int> (history.size()) - 1;
+
+	// enough grains and storage to cover every grain synthesis might still ask for
+	const auto window = latency + 3 * maxPeriod + blocksize;
+
+	grains.resize (static_cast<size_t> (juce::nextPowerOfTwo (window / minPeriod + 2)));
+	storage.assign (static_cast<size_t> (juce::nextPowerOfTwo (4 * window)), SampleType (0));
+
+	reset();
+}
+
+template <typename SampleType>
+void GrainCache<SampleType>::reset()
+{
+	std::fill (history.begin(), history.end(), SampleType (0));
+
+	totalSamples	  = 0;
+	nextMark		  = maxPeriod;
+	lastMark		  = 0;
+	lastAudibleSample = 0;
+	numGrainsAdded	  = 0;
+	storageWritePos	  = 0;
+	lastBlocksize	  = 0;
+	inputFrequency	  = 0.f;
+}
+
+template <typename SampleType>
+void GrainCache<SampleType>::analyze (const SampleType* input, int numSamples, float inputFreq)
+{
+	writeHistory (input, numSamples);
+
+	lastAudibleSample = totalSamples;
+	inputFrequency	  = inputFreq;
+
+	const auto pitched = inputFreq > 0.f;
+
+	const auto period = pitched ? juce::jlimit (minPeriod, maxPeriod, juce::roundToInt (samplerate / inputFreq))
+								: maxPeriod / 2;
+
+	placeMarks (period, pitched);
+}
+
+template <typename SampleType>
+void GrainCache<SampleType>::analyzeSilence (int numSamples)
+{
+	writeHistory (nullptr, numSamples);
+
+	inputFrequency = 0.f;
+
+	placeMarks (maxPeriod / 2, false);
+}
+
+template <typename SampleType>
+void GrainCache<SampleType>::writeHistory (const SampleType* input, int numSamples)
+{
+	const auto size	 = static_cast<int> (history.size());
+	const auto start = static_cast<int> (totalSamples & historyMask);
+
+	// copy in at most two runs, split where the ring wraps around
+	for (auto done = 0; done < numSamples;)
+	{
+		const auto writePos = (start + done) & historyMask;
+		const auto run		= std::min (numSamples - done, size - writePos);
+
+		if (input == nullptr)
+			std::fill_n (history.data() + writePos, run, SampleType (0));
+		else
+			std::copy_n (input + done, run, history.data() + writePos);
+
+		done += run;
+	}
+
+	totalSamples += numSamples;
+	lastBlocksize = numSamples;
+}
+
+template <typename SampleType>
+bool GrainCache<SampleType>::isOutputSilent() const noexcept
+{
+	// a sample of output comes from grains synthesized up to a period before it, which are copies
+	// of cached grains centred up to another period earlier, each reaching back one more period
+	return getOutputBlockStart() - 3 * maxPeriod > lastAudibleSample;
+}
+
+template <typename SampleType>
+void GrainCache<SampleType>::placeMarks (int period, bool pitched)
+{
+	const auto oldestAvailable = totalSamples - static_cast<juce::int64> (history.size());
+
+	// a grain can only be cut once the whole of its right half has arrived
+	while (nextMark + period <= totalSamples)
+	{
+		auto mark = nextMark;
+
+		if (mark - period < oldestAvailable)
+		{
+			nextMark = oldestAvailable + period;
+			continue;
+		}
+
+		if (pitched)
+		{
+			const auto searchRadius = period / 4;
+
+			mark = findPeak (std::max (mark - searchRadius, lastMark + 1),
+							 std::min (mark + searchRadius + 1, totalSamples - period + 1));
+		}
+
+		addGrain (mark, period, pitched);
+
+		lastMark = mark;
+		nextMark = mark + period;
+	}
+}
+
+template <typename SampleType>
+juce::int64 GrainCache<SampleType>::findPeak (juce::int64 start, juce::int64 end) const noexcept
+{
+	auto peakPos   = start;
+	auto peakValue = SampleType (0);
+
+	for (auto pos = start; pos < end; ++pos)
+	{
+		const auto value = std::abs (getHistorySample (pos));
+
+		if (value > peakValue)
+		{
+			peakValue = value;
+			peakPos	  = pos;
+		}
+	}
+
+	return peakPos;
+}
+
+template <typename SampleType>
+void GrainCache<SampleType>::addGrain (juce::int64 centre, int halfLength, bool pitched)
+{
+	const auto length = 2 * halfLength;
+	const auto start  = centre - halfLength;
+
+	auto& grain = grains[static_cast<size_t> (numGrainsAdded++ & static_cast<juce::int64> (grains.size() - 1))];
+
+	grain.centre	 = centre;
+	grain.halfLength = halfLength;
+	grain.pitched	 = pitched;
+	grain.silent	 = start >= lastAudibleSample;
+
+	if (grain.silent)
+		return;
+
+	if (storageWritePos + length > static_cast<int> (storage.size()))
+		storageWritePos = 0;
+
+	grain.storageOffset = storageWritePos;
+
+	auto*	   dest	 = storage.data() + storageWritePos;
+	const auto phase = juce::MathConstants<double>::twoPi / static_cast<double> (length);
+
+	for (auto i = 0; i < length; ++i)
+	{
+		const auto window = SampleType (0.5 - 0.5 * std::cos (phase * (i + 0.5)));
+		dest[i]			  = getHistorySample (start + i) * window;
+	}
+
+	storageWritePos += length;
+}
+
+template <typename SampleType>
+const typename GrainCache<SampleType>::Grain* GrainCache<SampleType>::getGrainClosestTo (juce::int64 position) const noexcept
+{
+	if (numGrainsAdded == 0)
+		return nullptr;
+
+	const auto capacity = static_cast<juce::int64> (grains.size());
+	const auto mask		= capacity - 1;
+
+	auto lo = std::max (juce::int64 (0), numGrainsAdded - capacity);
+	auto hi = numGrainsAdded - 1;
+
+	const auto centreOf = [&] (juce::int64 index)
+	{ return grains[static_cast<size_t> (index & mask)].centre; };
+
+	// grain centres increase monotonically, so binary search for the first one at or after position
+	while (lo < hi)
+	{
+		const auto mid = lo + (hi - lo) / 2;
+
+		if (centreOf (mid) < position)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo > 0 && lo > numGrainsAdded - capacity
+		&& position - centreOf (lo - 1) < centreOf (lo) - position)
+		--lo;
+
+	return &grains[static_cast<size_t> (lo & mask)];
+}
+
+template <typename SampleType>
+const SampleType* GrainCache<SampleType>::getGrainSamples (const Grain& grain) const noexcept
+{
+	return storage.data() + grain.storageOffset;
+}
+
+template <typename SampleType>
+SampleType GrainCache<SampleType>::getHistorySample (juce::int64 position) const noexcept
+{
+	return history[static_cast<size_t> (position & historyMask)];
+}
+
+template class GrainCache<float>;
+template class GrainCache<double>;
+
+}  // namespace Imogen
@@ -0,0 +1,91 @@
+#pragma once
+
+namespace Imogen
+{
+/* Places pitch marks on the processed input and stores one windowed grain per mark.
+   The cache is filled once per block, then read by every harmony voice and by the lead's pitch
+   corrector, so windowing costs the same no matter how many voices are sounding.
+   All positions are absolute sample indices into the input stream.
+ */
+template <typename SampleType>
+class GrainCache
+{
+public:
+
+	struct Grain
+	{
+		juce::int64 centre { 0 };
+		int			halfLength { 0 };  // the grain spans [centre - halfLength, centre + halfLength)
+		int			storageOffset { 0 };
+		bool		pitched { false };
+		bool		silent { false };  // silent grains aren't windowed or stored, and synthesis skips them
+	};
+
+	/* The highest pitch that grains are cut for. */
+	static constexpr auto maxInputFreq = 1500.f;
+
+	explicit GrainCache (float minInputFreqHz = 60.f);
+
+	/* Sets the lowest pitch that can be tracked, which determines the latency. Takes effect the next time the cache is prepared. */
+	void setMinInputFrequency (float minInputFreqHz);
+
+	void prepare (double samplerate, int blocksize);
+
+	void reset();
+
+	/* inputFreq should be 0 if the input is currently unpitched. */
+	void analyze (const SampleType* input, int numSamples, float inputFreq);
+
+	/* Advances the cache over a block of silent input without looking at any samples. */
+	void analyzeSilence (int numSamples);
+
+	/* True if nothing audible can reach synthesis for the block just analyzed. */
+	bool isOutputSilent() const noexcept;
+
+	const Grain* getGrainClosestTo (juce::int64 position) const noexcept;
+
+	const SampleType* getGrainSamples (const Grain& grain) const noexcept;
+
+	/* The range of input positions that synthesis should render for the block just analyzed. */
+	juce::int64 getOutputBlockStart() const noexcept { return totalSamples - lastBlocksize - latency; }
+	int			getLastBlocksize() const noexcept { return lastBlocksize; }
+
+	int	   getLatencySamples() const noexcept { return latency; }
+	int	   getMinPeriod() const noexcept { return minPeriod; }
+	int	   getMaxPeriod() const noexcept { return maxPeriod; }
+	double getSamplerate() const noexcept { return samplerate; }
+	float  getInputFrequency() const noexcept { return inputFrequency; }
+
+private:
+
+	void		placeMarks (int period, bool pitched);
+	juce::int64 findPeak (juce::int64 start, juce::int64 end) const noexcept;
+	void		addGrain (juce::int64 centre, int halfLength, bool pitched);
+
+	void writeHistory (const SampleType* input, int numSamples);
+
+	SampleType getHistorySample (juce::int64 position) const noexcept;
+
+	float minFreq;
+
+	double samplerate { 0. };
+	int	   minPeriod { 0 }, maxPeriod { 0 }, latency { 0 }, lastBlocksize { 0 };
+	float  inputFrequency { 0.f };
+
+	juce::int64 totalSamples { 0 }, nextMark { 0 }, lastMark { 0 };
+
+	// the end of the most recent block of input that wasn't silent
+	juce::int64 lastAudibleSample { 0 };
+
+	std::vector<SampleType> history;
+	int						historyMask { 0 };
+
+	std::vector<Grain> grains;
+	juce::int64		   numGrainsAdded { 0 };
+
+	std::vector<SampleType> storage;
+	int						storageWritePos { 0 };
+
+};
+
+}  // namespace Imogen
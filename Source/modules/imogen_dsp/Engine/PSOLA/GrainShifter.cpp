@@ -0,0 +1,161 @@
+
+namespace Imogen
+{
+template <typename SampleType>
+GrainShifter<SampleType>::GrainShifter (const Cache& cacheToUse)
+	: cache (cacheToUse)
+{
+}
+
+template <typename SampleType>
+void GrainShifter<SampleType>::prepare (int blocksize)
+{
+	accumulator.assign (static_cast<size_t> (juce::nextPowerOfTwo (blocksize + 2 * cache.getMaxPeriod() + 1)), SampleType (0));
+	accumulatorMask = static_cast<juce::int64> (accumulator.size()) - 1;
+
+	ownBatch.reserve (getMaxGrainsPerBlock (blocksize));
+
+	reset();
+}
+
+template <typename SampleType>
+void GrainShifter<SampleType>::reset()
+{
+	std::fill (accumulator.begin(), accumulator.end(), SampleType (0));
+
+	position	  = -1;
+	synthesisMark = 0.;
+}
+
+template <typename SampleType>
+void GrainShifter<SampleType>::getSamples (juce::AudioBuffer<SampleType>& output)
+{
+	const auto numSamples = output.getNumSamples();
+
+	getSamples (output.getWritePointer (0), numSamples);
+
+	for (auto chan = 1; chan < output.getNumChannels(); ++chan)
+		output.copyFrom (chan, 0, output, 0, 0, numSamples);
+}
+
+template <typename SampleType>
+void GrainShifter<SampleType>::getSamples (SampleType* output, int numSamples)
+{
+	ownBatch.clear();
+	queueGrains (numSamples, ownBatch);
+	ownBatch.process();
+
+	readSamples (output, numSamples);
+}
+
+template <typename SampleType>
+void GrainShifter<SampleType>::queueGrains (int numSamples, GrainBatch<SampleType>& batch)
+{
+	const auto blockStart = cache.getOutputBlockStart();
+	const auto blockEnd	  = blockStart + cache.getLastBlocksize();
+
+	// if this shifter sat out some blocks, pick up again at the start of the current one
+	if (position < blockStart || position + numSamples > blockEnd)
+	{
+		std::fill (accumulator.begin(), accumulator.end(), SampleType (0));
+
+		position	  = blockStart;
+		synthesisMark = static_cast<double> (blockStart);
+	}
+
+	placeGrains (position + numSamples, batch);
+}
+
+template <typename SampleType>
+void GrainShifter<SampleType>::readSamples (SampleType* output, int numSamples) noexcept
+{
+	for (auto i = 0; i < numSamples; ++i)
+	{
+		auto& sample = accumulator[static_cast<size_t> ((position + i) & accumulatorMask)];
+
+		output[i] = sample;
+		sample	  = SampleType (0);
+	}
+
+	position += numSamples;
+}
+
+template <typename SampleType>
+int GrainShifter<SampleType>::getMaxGrainsPerBlock (int blocksize) const noexcept
+{
+	// grains are never placed closer together than the cache's shortest period, and each one may
+	// be split in two where it wraps around the accumulator
+	const auto span = blocksize + 2 * cache.getMaxPeriod();
+
+	return 2 * (span / cache.getMinPeriod() + 2);
+}
+
+template <typename SampleType>
+void GrainShifter<SampleType>::placeGrains (juce::int64 endPosition, GrainBatch<SampleType>& batch)
+{
+	const auto targetPeriod = targetFrequency > 0.f
+								? std::max (static_cast<double> (cache.getMinPeriod()), cache.getSamplerate() / static_cast<double> (targetFrequency))
+								: 0.;
+
+	while (true)
+	{
+		const auto centre = static_cast<juce::int64> (synthesisMark);
+
+		const auto* grain = cache.getGrainClosestTo (centre);
+
+		if (grain == nullptr)
+		{
+			synthesisMark = static_cast<double> (endPosition);
+			return;
+		}
+
+		if (centre - grain->halfLength >= endPosition)
+			return;
+
+		if (grain->silent)
+		{
+			synthesisMark += std::max (targetPeriod, static_cast<double> (grain->halfLength));
+		}
+		else if (grain->pitched && targetPeriod > 0.)
+		{
+			// more (or fewer) overlapping grains per period changes the level, so compensate
+			const auto gain = std::min (1., targetPeriod / static_cast<double> (grain->halfLength));
+
+			queueGrain (*grain, centre, static_cast<SampleType> (gain), batch);
+			synthesisMark += targetPeriod;
+		}
+		else
+		{
+			queueGrain (*grain, centre, SampleType (1), batch);
+			synthesisMark += grain->halfLength;
+		}
+	}
+}
+
+template <typename SampleType>
+void GrainShifter<SampleType>::queueGrain (const typename Cache::Grain& grain, juce::int64 centre, SampleType gain,
+										   GrainBatch<SampleType>& batch) noexcept
+{
+	const auto* samples = cache.getGrainSamples (grain);
+
+	const auto grainStart = centre - grain.halfLength;
+	const auto skip		  = static_cast<int> (std::max (juce::int64 (0), position - grainStart));
+	const auto length	  = 2 * grain.halfLength - skip;
+
+	if (length <= 0)
+		return;
+
+	// the kernel wants contiguous runs, so split the grain where it wraps around the accumulator
+	const auto destStart = static_cast<int> ((grainStart + skip) & accumulatorMask);
+	const auto firstRun	 = std::min (length, static_cast<int> (accumulator.size()) - destStart);
+
+	batch.add (samples + skip, accumulator.data() + destStart, firstRun, gain);
+
+	if (firstRun < length)
+		batch.add (samples + skip + firstRun, accumulator.data(), length - firstRun, gain);
+}
+
+template class GrainShifter<float>;
+template class GrainShifter<double>;
+
+}  // namespace Imogen
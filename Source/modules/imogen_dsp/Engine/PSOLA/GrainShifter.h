@@ -0,0 +1,60 @@
+#pragma once
+
+#include "GrainCache.h"
+#include "OverlapAdd.h"
+
+namespace Imogen
+{
+/* Resynthesizes the cached grains at a new pitch. A shifter only holds its own overlap-add
+   accumulator and synthesis position, so each voice costs very little memory.
+ */
+template <typename SampleType>
+class GrainShifter
+{
+public:
+
+	using Cache = GrainCache<SampleType>;
+
+	explicit GrainShifter (const Cache& cacheToUse);
+
+	void prepare (int blocksize);
+
+	void reset();
+
+	/* A frequency of 0 plays the input back at its own pitch. */
+	void setPitch (float frequency) noexcept { targetFrequency = frequency; }
+
+	void getSamples (SampleType* output, int numSamples);
+
+	void getSamples (juce::AudioBuffer<SampleType>& output);
+
+	/* Splits getSamples() in two, so that the grains of many shifters can be queued together and
+	   overlap-added in one pass: queue this shifter's grains for the next numSamples onto the batch,
+	   process the batch, then read the samples out.
+	 */
+	void queueGrains (int numSamples, GrainBatch<SampleType>& batch);
+	void readSamples (SampleType* output, int numSamples) noexcept;
+
+	/* The most batch entries that queueGrains() can add for a block of this size. */
+	int getMaxGrainsPerBlock (int blocksize) const noexcept;
+
+private:
+
+	void placeGrains (juce::int64 endPosition, GrainBatch<SampleType>& batch);
+
+	void queueGrain (const typename Cache::Grain& grain, juce::int64 centre, SampleType gain, GrainBatch<SampleType>& batch) noexcept;
+
+	const Cache& cache;
+
+	std::vector<SampleType> accumulator;
+	juce::int64				accumulatorMask { 0 };
+
+	GrainBatch<SampleType> ownBatch;
+
+	juce::int64 position { -1 };
+	double		synthesisMark { 0. };
+
+	float targetFrequency { 0.f };
+};
+
+}  // namespace Imogen
@@ -0,0 +1,48 @@
+
+namespace Imogen
+{
+template <typename SampleType>
+void GrainBatch<SampleType>::reserve (int maxGrains)
+{
+	const auto capacity = static_cast<size_t> (maxGrains);
+
+	sources.resize (capacity);
+	dests.resize (capacity);
+	lengths.resize (capacity);
+	gains.resize (capacity);
+
+	clear();
+}
+
+template <typename SampleType>
+void GrainBatch<SampleType>::add (const SampleType* source, SampleType* dest, int length, SampleType gain) noexcept
+{
+	jassert (getCapacity() > 0);
+
+	// entries only ever add into their destinations, so processing early if the batch fills up
+	// gives exactly the same result
+	if (size == getCapacity())
+	{
+		process();
+		clear();
+	}
+
+	const auto index = static_cast<size_t> (size++);
+
+	sources[index] = source;
+	dests[index]   = dest;
+	lengths[index] = length;
+	gains[index]   = gain;
+}
+
+template <typename SampleType>
+void GrainBatch<SampleType>::process() const noexcept
+{
+	for (size_t i = 0; i < static_cast<size_t> (size); ++i)
+		juce::FloatVectorOperations::addWithMultiply (dests[i], sources[i], gains[i], lengths[i]);
+}
+
+template struct GrainBatch<float>;
+template struct GrainBatch<double>;
+
+}  // namespace Imogen
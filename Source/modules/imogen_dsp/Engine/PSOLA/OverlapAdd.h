@@ -0,0 +1,31 @@
+#pragma once
+
+namespace Imogen
+{
+/* A queue of grain placements, possibly from many voices, each one a run of source samples to be
+   added into a destination with a gain. Queueing them lets the shifters do all their bookkeeping
+   first, and then process() adds every run in one pass, each with JUCE's vectorised
+   addWithMultiply. The runs are still summed one at a time, into whichever buffer each belongs to.
+ */
+template <typename SampleType>
+struct GrainBatch
+{
+	void reserve (int maxGrains);
+
+	void clear() noexcept { size = 0; }
+
+	void add (const SampleType* source, SampleType* dest, int length, SampleType gain) noexcept;
+
+	void process() const noexcept;
+
+	int getCapacity() const noexcept { return static_cast<int> (lengths.size()); }
+
+	int size { 0 };
+
+	std::vector<const SampleType*> sources;
+	std::vector<SampleType*>	   dests;
+	std::vector<int>			   lengths;
+	std::vector<SampleType>		   gains;
+};
+
+}  // namespace Imogen
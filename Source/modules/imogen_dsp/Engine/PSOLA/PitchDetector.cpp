@@ -0,0 +1,407 @@
+
+namespace Imogen
+{
+template <typename SampleType>
+void PitchDetector<SampleType>::setFrequencyRange (float minHz, float maxHz)
+{
+	jassert (minHz > 0.f && minHz < maxHz);
+
+	minFreq = minHz;
+	maxFreq = maxHz;
+}
+
+template <typename SampleType>
+void PitchDetector<SampleType>::prepare (double newSamplerate)
+{
+	jassert (newSamplerate > 0.);
+
+	// a new estimate roughly every 5 ms
+	constexpr auto hopSeconds = 0.005;
+
+	inputSamplerate = newSamplerate;
+	decimation		= 1;
+
+	while (inputSamplerate / (2 * decimation) >= minAnalysisRate)
+		decimation *= 2;
+
+	samplerate = inputSamplerate / decimation;
+	minLag	   = std::max (2, static_cast<int> (samplerate / maxFreq));
+	maxLag	   = static_cast<int> (std::ceil (samplerate / minFreq));
+	hopSize	   = juce::nextPowerOfTwo (juce::roundToInt (samplerate * hopSeconds));
+	numBlocks  = std::max (1, (maxLag + hopSize - 1) / hopSize);
+
+	// a block's linear correlation with its segment at lags 0 to maxLag never wraps around at this size
+	const auto fftSize = juce::nextPowerOfTwo (hopSize + maxLag);
+
+	fft = std::make_unique<juce::dsp::FFT> (juce::roundToInt (std::log2 (fftSize)));
+
+	history.resize (static_cast<size_t> (juce::nextPowerOfTwo (getWindowSize() + 2 * hopSize)));
+	historyMask = static_cast<int> (history.size()) - 1;
+
+	correlations.resize (static_cast<size_t> (numBlocks * (maxLag + 1)));
+	blockEnergies.resize (static_cast<size_t> (numBlocks));
+
+	blockSpectrum.resize (static_cast<size_t> (2 * fftSize));
+	segmentSpectrum.resize (blockSpectrum.size());
+
+	nsdf.resize (static_cast<size_t> (maxLag + 1));
+
+	// a sixth order Butterworth, well below the decimated Nyquist, but well above any fundamental
+	const auto cutoff = static_cast<float> (samplerate * 0.3);
+
+	for (auto [stage, Q] : { std::pair { 0, 0.5176f }, std::pair { 1, 0.7071f }, std::pair { 2, 1.9319f } })
+		antiAlias[static_cast<size_t> (stage)].coefs = BiquadCascade<double>::Coefficients::makeLowPass (inputSamplerate, cutoff, Q);
+
+	// refining searches lags up to one decimated sample past the longest, over a window a few periods long
+	fullRateHistory.resize (static_cast<size_t> (juce::nextPowerOfTwo ((refineWindowPeriods + 1) * (maxLag + 2) * decimation)));
+	fullRateMask = static_cast<int> (fullRateHistory.size()) - 1;
+
+	reset();
+}
+
+template <typename SampleType>
+void PitchDetector<SampleType>::reset()
+{
+	std::fill (history.begin(), history.end(), 0.f);
+	std::fill (fullRateHistory.begin(), fullRateHistory.end(), 0.f);
+
+	for (auto& stage : antiAlias)
+		stage.z1 = stage.z2 = 0.;
+
+	totalSamples	  = 0;
+	totalInputSamples = 0;
+	decimationPhase	  = 0;
+	nextBlock		  = 0;
+	numBlocksAnalyzed = 0;
+	frequency		  = 0.f;
+	confidence		  = 0.f;
+
+	lastEstimatePosition = 0;
+}
+
+template <typename SampleType>
+void PitchDetector<SampleType>::process (const SampleType* input, int numSamples)
+{
+	if (decimation == 1)
+	{
+		analyze (input, numSamples);
+		return;
+	}
+
+	for (auto i = 0; i < numSamples; ++i)
+	{
+		const auto x = input == nullptr ? 0.f : static_cast<float> (input[i]);
+
+		fullRateHistory[static_cast<size_t> (totalInputSamples++ & fullRateMask)] = x;
+
+		auto y = static_cast<double> (x);
+
+		for (auto& stage : antiAlias)
+		{
+			const auto& c	= stage.coefs;
+			const auto	out = c.b0 * y + stage.z1;
+
+			stage.z1 = c.b1 * y - c.a1 * out + stage.z2;
+			stage.z2 = c.b2 * y - c.a2 * out;
+
+			y = out;
+		}
+
+		// an estimate made here then lines up with the end of the full rate history
+		if (++decimationPhase == decimation)
+		{
+			decimationPhase = 0;
+
+			const auto decimated = static_cast<float> (y);
+			analyze (&decimated, 1);
+		}
+	}
+}
+
+template <typename SampleType>
+template <typename InputType>
+void PitchDetector<SampleType>::analyze (const InputType* input, int numSamples)
+{
+	const auto size = static_cast<int> (history.size());
+
+	for (auto done = 0; done < numSamples;)
+	{
+		// stop writing as soon as the next block has all the samples its longest lag reaches
+		const auto blockStart = nextBlock * hopSize;
+		const auto readyAt	  = blockStart + hopSize + maxLag;
+
+		const auto toWrite = static_cast<int> (std::min (static_cast<juce::int64> (numSamples - done), readyAt - totalSamples));
+
+		for (auto written = 0; written < toWrite;)
+		{
+			const auto writePos = static_cast<int> ((totalSamples + written) & historyMask);
+			const auto run		= std::min (toWrite - written, size - writePos);
+
+			auto* dest = history.data() + writePos;
+
+			if (input == nullptr)
+				std::fill_n (dest, run, 0.f);
+			else
+				std::transform (input + done + written, input + done + written + run, dest,
+								[] (InputType s) { return static_cast<float> (s); });
+
+			written += run;
+		}
+
+		totalSamples += toWrite;
+		done += toWrite;
+
+		if (totalSamples == readyAt)
+		{
+			analyzeBlock (blockStart, static_cast<int> (nextBlock % numBlocks));
+
+			++nextBlock;
+			numBlocksAnalyzed = std::min (numBlocks, numBlocksAnalyzed + 1);
+
+			estimate();
+		}
+	}
+}
+
+template <typename SampleType>
+void PitchDetector<SampleType>::analyzeBlock (juce::int64 blockStart, int slot)
+{
+	auto* correlation = correlations.data() + slot * (maxLag + 1);
+
+	auto energy = 0.;
+
+	for (auto i = 0; i < hopSize; ++i)
+	{
+		const auto sample = static_cast<double> (getHistorySample (blockStart + i));
+		energy += sample * sample;
+	}
+
+	blockEnergies[static_cast<size_t> (slot)] = energy;
+
+	// a silent block can't correlate with anything, so there's no need to transform it
+	if (energy == 0.)
+	{
+		std::fill_n (correlation, maxLag + 1, 0.f);
+		return;
+	}
+
+	std::fill (blockSpectrum.begin(), blockSpectrum.end(), 0.f);
+	std::fill (segmentSpectrum.begin(), segmentSpectrum.end(), 0.f);
+
+	for (auto i = 0; i < hopSize; ++i)
+		blockSpectrum[static_cast<size_t> (i)] = getHistorySample (blockStart + i);
+
+	for (auto i = 0; i < hopSize + maxLag; ++i)
+		segmentSpectrum[static_cast<size_t> (i)] = getHistorySample (blockStart + i);
+
+	fft->performRealOnlyForwardTransform (blockSpectrum.data(), true);
+	fft->performRealOnlyForwardTransform (segmentSpectrum.data(), true);
+
+	// correlating is multiplying the segment's spectrum by the conjugate of the block's
+	const auto numBins = fft->getSize() / 2 + 1;
+
+	for (auto bin = 0; bin < numBins; ++bin)
+	{
+		const auto re = static_cast<size_t> (2 * bin), im = re + 1;
+
+		const auto ar = blockSpectrum[re], ai = blockSpectrum[im];
+		const auto br = segmentSpectrum[re], bi = segmentSpectrum[im];
+
+		blockSpectrum[re] = ar * br + ai * bi;
+		blockSpectrum[im] = ar * bi - ai * br;
+	}
+
+	std::fill (blockSpectrum.begin() + 2 * numBins, blockSpectrum.end(), 0.f);
+
+	fft->performRealOnlyInverseTransform (blockSpectrum.data());
+
+	std::copy_n (blockSpectrum.data(), maxLag + 1, correlation);
+}
+
+template <typename SampleType>
+void PitchDetector<SampleType>::estimate()
+{
+	frequency  = 0.f;
+	confidence = 0.f;
+
+	lastEstimatePosition = getNumSamplesProcessed();
+
+	if (numBlocksAnalyzed < numBlocks)
+		return;
+
+	const auto windowSize  = numBlocks * hopSize;
+	const auto windowStart = (nextBlock - numBlocks) * hopSize;
+
+	const auto energy = std::accumulate (blockEnergies.begin(), blockEnergies.end(), 0.);
+
+	if (energy < 1.0e-9 * windowSize)
+		return;
+
+	// the autocorrelation over the window is the sum of its blocks' cached correlations
+	std::fill (nsdf.begin(), nsdf.end(), 0.f);
+
+	for (auto block = 0; block < numBlocks; ++block)
+		juce::FloatVectorOperations::add (nsdf.data(), correlations.data() + block * (maxLag + 1), maxLag + 1);
+
+	// the energy of the window shifted by each lag, updated one sample at a time
+	auto shiftedEnergy = energy;
+
+	nsdf[0] = 1.f;
+
+	for (auto lag = 1; lag <= maxLag; ++lag)
+	{
+		const auto entering = static_cast<double> (getHistorySample (windowStart + windowSize + lag - 1));
+		const auto leaving	= static_cast<double> (getHistorySample (windowStart + lag - 1));
+
+		shiftedEnergy += entering * entering - leaving * leaving;
+
+		const auto denominator = energy + std::max (0., shiftedEnergy);
+
+		nsdf[static_cast<size_t> (lag)] = denominator > 0. ? static_cast<float> (2. * nsdf[static_cast<size_t> (lag)] / denominator) : 0.f;
+	}
+
+	// McLeod's peak picking: the highest point of each positive lobe after the first is a key maximum,
+	// and the first key maximum that comes close enough to the highest one gives the period
+	const auto forEachKeyMaximum = [this] (auto&& callback)
+	{
+		auto lag = 0;
+
+		while (lag < maxLag && nsdf[static_cast<size_t> (lag)] > 0.f)
+			++lag;
+
+		while (lag < maxLag)
+		{
+			while (lag < maxLag && nsdf[static_cast<size_t> (lag)] <= 0.f)
+				++lag;
+
+			if (lag >= maxLag)
+				return;
+
+			auto peak = lag;
+
+			for (; lag < maxLag && nsdf[static_cast<size_t> (lag)] > 0.f; ++lag)
+				if (nsdf[static_cast<size_t> (lag)] > nsdf[static_cast<size_t> (peak)])
+					peak = lag;
+
+			if (peak >= minLag && callback (peak))
+				return;
+		}
+	};
+
+	auto highest = 0.f;
+
+	forEachKeyMaximum ([&] (int lag)
+					   {
+						   highest = std::max (highest, nsdf[static_cast<size_t> (lag)]);
+						   return false;
+					   });
+
+	if (highest <= 0.f)
+		return;
+
+	auto chosen = 0;
+
+	forEachKeyMaximum ([&] (int lag)
+					   {
+						   if (nsdf[static_cast<size_t> (lag)] < peakThreshold * highest)
+							   return false;
+
+						   chosen = lag;
+						   return true;
+					   });
+
+	// a parabola through the peak and its neighbours gives the period to a fraction of a sample
+	const auto a = nsdf[static_cast<size_t> (chosen - 1)];
+	const auto b = nsdf[static_cast<size_t> (chosen)];
+	const auto c = nsdf[static_cast<size_t> (chosen + 1)];
+
+	const auto curvature = a - 2.f * b + c;
+	const auto shift	 = curvature < 0.f ? 0.5f * (a - c) / curvature : 0.f;
+
+	const auto period = static_cast<double> (chosen) + static_cast<double> (shift);
+
+	confidence = juce::jlimit (0.f, 1.f, b - 0.25f * (a - c) * shift);
+
+	const auto detected = decimation > 1 ? static_cast<float> (inputSamplerate / refinePeriod (period * decimation))
+										 : static_cast<float> (samplerate / period);
+
+	if (confidence >= minConfidence && detected >= minFreq && detected <= maxFreq)
+		frequency = detected;
+}
+
+/* Climbs the normalised square difference function at the full rate from the decimated estimate to
+   the nearest peak, then interpolates it. The integration window is a couple of periods long and
+   ends at the newest input, so each lag tried costs only a couple of periods of multiplies.
+ */
+template <typename SampleType>
+double PitchDetector<SampleType>::refinePeriod (double coarsePeriod) const noexcept
+{
+	const auto lowest  = std::max (2, static_cast<int> (coarsePeriod) - decimation);
+	const auto highest = std::min ((maxLag + 1) * decimation, static_cast<int> (coarsePeriod) + decimation + 1);
+
+	const auto length = juce::roundToInt (coarsePeriod) * refineWindowPeriods;
+
+	const auto nsdfAt = [&] (int lag)
+	{
+		const auto start = totalInputSamples - length - lag;
+
+		auto correlation = 0., energy = 0.;
+
+		for (auto i = 0; i < length; ++i)
+		{
+			const auto x = static_cast<double> (fullRateHistory[static_cast<size_t> ((start + i) & fullRateMask)]);
+			const auto y = static_cast<double> (fullRateHistory[static_cast<size_t> ((start + i + lag) & fullRateMask)]);
+
+			correlation += x * y;
+			energy += x * x + y * y;
+		}
+
+		return energy > 0. ? 2. * correlation / energy : 0.;
+	};
+
+	auto lag = juce::jlimit (lowest + 1, highest - 1, juce::roundToInt (coarsePeriod));
+
+	auto left = nsdfAt (lag - 1), centre = nsdfAt (lag), right = nsdfAt (lag + 1);
+
+	const auto step = left > centre && left > right ? -1 : (right > centre ? 1 : 0);
+
+	// the decimated estimate is already within a sample or two, so this only ever takes a few steps
+	while (step != 0 && lag + step > lowest && lag + step < highest)
+	{
+		const auto next = step < 0 ? left : right;
+
+		if (next <= centre)
+			break;
+
+		lag += step;
+
+		if (step < 0)
+		{
+			right  = centre;
+			centre = left;
+			left   = nsdfAt (lag - 1);
+		}
+		else
+		{
+			left   = centre;
+			centre = right;
+			right  = nsdfAt (lag + 1);
+		}
+	}
+
+	const auto curvature = left - 2. * centre + right;
+	const auto shift	 = curvature < 0. ? 0.5 * (left - right) / curvature : 0.;
+
+	return static_cast<double> (lag) + juce::jlimit (-1., 1., shift);
+}
+
+template <typename SampleType>
+float PitchDetector<SampleType>::getHistorySample (juce::int64 position) const noexcept
+{
+	return history[static_cast<size_t> (position & historyMask)];
+}
+
+template class PitchDetector<float>;
+template class PitchDetector<double>;
+
+}  // namespace Imogen
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <imogen_dsp/Engine/effects/PostHarmony/BiquadCascade.h>
+
+namespace Imogen
+{
+/* A streaming McLeod pitch detector. The normalised square difference function is taken over a
+   fixed integration window of about one longest period, against lags of up to one longest period,
+   and re-estimated every hop.
+
+   The window is split into hop-sized blocks, and each block's correlation with the samples that
+   follow it is computed once with an FFT when its last lag has arrived, then kept until the block
+   leaves the window. So each new estimate costs one block's transforms plus summing the cached
+   correlations, instead of correlating the whole window again from scratch.
+
+   At high samplerates the period is found on a low-passed and decimated copy of the input, so the
+   cost stays about the same whatever the samplerate, then refined at the full rate by searching
+   only the few lags around the decimated estimate.
+ */
+template <typename SampleType>
+class PitchDetector
+{
+public:
+
+	/* Takes effect the next time the detector is prepared. */
+	void setFrequencyRange (float minHz, float maxHz);
+
+	void prepare (double samplerate);
+
+	void reset();
+
+	/* Passing nullptr analyzes the same number of samples of silence. */
+	void process (const SampleType* input, int numSamples);
+
+	/* The most recently detected frequency, or 0 if the input is currently unpitched. */
+	float getFrequency() const noexcept { return frequency; }
+	bool  isPitched() const noexcept { return frequency > 0.f; }
+
+	/* How periodic the input was at the detected period, from 0 to 1, even if that wasn't periodic
+	   enough to count as pitched.
+	 */
+	float getConfidence() const noexcept { return confidence; }
+
+	/* The span of input each estimate looks at, at the full rate: the integration window plus the longest lag. */
+	int getWindowSize() const noexcept { return (numBlocks * hopSize + maxLag) * decimation; }
+
+	/* How many samples have been processed since the detector was reset, and how many had been when
+	   the latest estimate was made, so that callers can tell where in a block it was made. Estimates
+	   are made every hop, which is a few milliseconds, so there is at most one in a short block.
+	 */
+	juce::int64 getNumSamplesProcessed() const noexcept { return decimation > 1 ? totalInputSamples : totalSamples; }
+	juce::int64 getLastEstimatePosition() const noexcept { return lastEstimatePosition; }
+
+	/* How many input samples make up each sample the period is detected on. */
+	int getDecimation() const noexcept { return decimation; }
+
+	/* Below this confidence the input is treated as unpitched. */
+	static constexpr auto minConfidence = 0.75f;
+
+private:
+
+	template <typename InputType>
+	void analyze (const InputType* input, int numSamples);
+
+	void analyzeBlock (juce::int64 blockStart, int slot);
+	void estimate();
+
+	double refinePeriod (double coarsePeriod) const noexcept;
+
+	float getHistorySample (juce::int64 position) const noexcept;
+
+	float minFreq { 60.f }, maxFreq { 1500.f };
+
+	// the samplerate and lags here are those of the decimated signal
+	double samplerate { 0. };
+	int	   hopSize { 0 }, minLag { 0 }, maxLag { 0 }, numBlocks { 0 };
+
+	double inputSamplerate { 0. };
+	int	   decimation { 1 }, decimationPhase { 0 };
+
+	struct AntiAliasStage
+	{
+		BiquadCascade<double>::Coefficients coefs;
+
+		double z1 { 0. }, z2 { 0. };
+	};
+
+	std::array<AntiAliasStage, 3> antiAlias;
+
+	// the undecimated input, for refining the period
+	std::vector<float> fullRateHistory;
+	int				   fullRateMask { 0 };
+	juce::int64		   totalInputSamples { 0 };
+
+	std::unique_ptr<juce::dsp::FFT> fft;
+
+	std::vector<float> history;
+	int				   historyMask { 0 };
+
+	juce::int64 totalSamples { 0 }, nextBlock { 0 };
+
+	// each block's correlation with the following samples at lags 0 to maxLag, and its energy
+	std::vector<float>	correlations;
+	std::vector<double> blockEnergies;
+	int					numBlocksAnalyzed { 0 };
+
+	std::vector<float> blockSpectrum, segmentSpectrum;
+	std::vector<float> nsdf;
+
+	float frequency { 0.f }, confidence { 0.f };
+
+	juce::int64 lastEstimatePosition { 0 };
+
+	// the key maxima after the first lobe must reach this fraction of the highest to be chosen
+	static constexpr auto peakThreshold = 0.9f;
+
+	// the input is halved until going any further would drop below this rate
+	static constexpr auto minAnalysisRate = 16000.;
+
+	static constexpr auto refineWindowPeriods = 2;
+};
+
+}  // namespace Imogen
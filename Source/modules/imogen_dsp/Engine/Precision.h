@@ -0,0 +1,36 @@
+#pragma once
+
+#ifndef IMOGEN_MIXED_PRECISION
+#	define IMOGEN_MIXED_PRECISION 1
+#endif
+
+namespace Imogen
+{
+/* The sample type that an engine's stages run in. With mixed precision on, Engine<double> converts
+   to float once on the way in and back once on the way out, so that every kernel inside runs at
+   full SIMD width; set IMOGEN_MIXED_PRECISION to 0 to run the double engine in double throughout.
+ */
+template <typename SampleType>
+struct KernelPrecision
+{
+	using Type = SampleType;
+};
+
+#if IMOGEN_MIXED_PRECISION
+template <>
+struct KernelPrecision<double>
+{
+	using Type = float;
+};
+#endif
+
+template <typename SampleType>
+using KernelType = typename KernelPrecision<SampleType>::Type;
+
+/* The type for state that float can't hold accurately enough, such as the feedback paths of
+   low-frequency filters. A stage opts in by keeping that state in this type, whatever its
+   own sample type is.
+ */
+using HighPrecision = double;
+
+}  // namespace Imogen
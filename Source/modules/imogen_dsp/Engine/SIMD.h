@@ -0,0 +1,210 @@
+#pragma once
+
+#if (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)) && ! defined(IMOGEN_NO_INTRINSICS)
+#	define IMOGEN_SSE 1
+#	include <immintrin.h>
+#else
+#	define IMOGEN_SSE 0
+#endif
+
+#if IMOGEN_SSE && defined(__AVX__)
+#	define IMOGEN_AVX 1
+#else
+#	define IMOGEN_AVX 0
+#endif
+
+namespace Imogen
+{
+/* Four samples that are worked on in lockstep, one per lane. Without SSE, this falls back to
+   plain loops that the compiler is free to vectorize on its own.
+ */
+template <typename SampleType>
+struct Lanes4
+{
+	static Lanes4 broadcast (SampleType value) noexcept { return { { value, value, value, value } }; }
+
+	static Lanes4 set (SampleType a, SampleType b, SampleType c, SampleType d) noexcept { return { { a, b, c, d } }; }
+
+	static Lanes4 load (const SampleType* source) noexcept { return { { source[0], source[1], source[2], source[3] } }; }
+
+	static Lanes4 gather (const SampleType* const* channels, int index) noexcept
+	{
+		return { { channels[0][index], channels[1][index], channels[2][index], channels[3][index] } };
+	}
+
+	void scatter (SampleType* const* channels, int index) const noexcept
+	{
+		for (auto lane = 0; lane < 4; ++lane)
+			channels[lane][index] = values[static_cast<size_t> (lane)];
+	}
+
+	void store (SampleType* dest) const noexcept { std::copy (values.begin(), values.end(), dest); }
+
+	friend Lanes4 operator+ (Lanes4 a, const Lanes4& b) noexcept
+	{
+		for (size_t lane = 0; lane < 4; ++lane)
+			a.values[lane] += b.values[lane];
+
+		return a;
+	}
+
+	friend Lanes4 operator- (Lanes4 a, const Lanes4& b) noexcept
+	{
+		for (size_t lane = 0; lane < 4; ++lane)
+			a.values[lane] -= b.values[lane];
+
+		return a;
+	}
+
+	friend Lanes4 operator* (Lanes4 a, const Lanes4& b) noexcept
+	{
+		for (size_t lane = 0; lane < 4; ++lane)
+			a.values[lane] *= b.values[lane];
+
+		return a;
+	}
+
+	friend Lanes4 max (Lanes4 a, const Lanes4& b) noexcept
+	{
+		for (size_t lane = 0; lane < 4; ++lane)
+			a.values[lane] = std::max (a.values[lane], b.values[lane]);
+
+		return a;
+	}
+
+	friend Lanes4 abs (Lanes4 a) noexcept
+	{
+		for (auto& value : a.values)
+			value = std::abs (value);
+
+		return a;
+	}
+
+	std::array<SampleType, 4> values;
+};
+
+#if IMOGEN_SSE
+
+template <>
+struct Lanes4<float>
+{
+	static Lanes4 broadcast (float value) noexcept { return { _mm_set1_ps (value) }; }
+
+	static Lanes4 set (float a, float b, float c, float d) noexcept { return { _mm_setr_ps (a, b, c, d) }; }
+
+	static Lanes4 load (const float* source) noexcept { return { _mm_loadu_ps (source) }; }
+
+	static Lanes4 gather (const float* const* channels, int index) noexcept
+	{
+		return { _mm_setr_ps (channels[0][index], channels[1][index], channels[2][index], channels[3][index]) };
+	}
+
+	void scatter (float* const* channels, int index) const noexcept
+	{
+		alignas (16) float out[4];
+		_mm_store_ps (out, values);
+
+		for (auto lane = 0; lane < 4; ++lane)
+			channels[lane][index] = out[lane];
+	}
+
+	void store (float* dest) const noexcept { _mm_storeu_ps (dest, values); }
+
+	friend Lanes4 operator+ (const Lanes4& a, const Lanes4& b) noexcept { return { _mm_add_ps (a.values, b.values) }; }
+	friend Lanes4 operator- (const Lanes4& a, const Lanes4& b) noexcept { return { _mm_sub_ps (a.values, b.values) }; }
+	friend Lanes4 operator* (const Lanes4& a, const Lanes4& b) noexcept { return { _mm_mul_ps (a.values, b.values) }; }
+
+	friend Lanes4 max (const Lanes4& a, const Lanes4& b) noexcept { return { _mm_max_ps (a.values, b.values) }; }
+	friend Lanes4 abs (const Lanes4& a) noexcept { return { _mm_andnot_ps (_mm_set1_ps (-0.f), a.values) }; }
+
+	__m128 values;
+};
+
+#	if IMOGEN_AVX
+
+template <>
+struct Lanes4<double>
+{
+	static Lanes4 broadcast (double value) noexcept { return { _mm256_set1_pd (value) }; }
+
+	static Lanes4 set (double a, double b, double c, double d) noexcept { return { _mm256_setr_pd (a, b, c, d) }; }
+
+	static Lanes4 load (const double* source) noexcept { return { _mm256_loadu_pd (source) }; }
+
+	static Lanes4 gather (const double* const* channels, int index) noexcept
+	{
+		return { _mm256_setr_pd (channels[0][index], channels[1][index], channels[2][index], channels[3][index]) };
+	}
+
+	void scatter (double* const* channels, int index) const noexcept
+	{
+		alignas (32) double out[4];
+		_mm256_store_pd (out, values);
+
+		for (auto lane = 0; lane < 4; ++lane)
+			channels[lane][index] = out[lane];
+	}
+
+	void store (double* dest) const noexcept { _mm256_storeu_pd (dest, values); }
+
+	friend Lanes4 operator+ (const Lanes4& a, const Lanes4& b) noexcept { return { _mm256_add_pd (a.values, b.values) }; }
+	friend Lanes4 operator- (const Lanes4& a, const Lanes4& b) noexcept { return { _mm256_sub_pd (a.values, b.values) }; }
+	friend Lanes4 operator* (const Lanes4& a, const Lanes4& b) noexcept { return { _mm256_mul_pd (a.values, b.values) }; }
+
+	friend Lanes4 max (const Lanes4& a, const Lanes4& b) noexcept { return { _mm256_max_pd (a.values, b.values) }; }
+	friend Lanes4 abs (const Lanes4& a) noexcept { return { _mm256_andnot_pd (_mm256_set1_pd (-0.), a.values) }; }
+
+	__m256d values;
+};
+
+#	else
+
+// SSE2 registers only hold two doubles, so use a pair of them
+template <>
+struct Lanes4<double>
+{
+	static Lanes4 broadcast (double value) noexcept { return { _mm_set1_pd (value), _mm_set1_pd (value) }; }
+
+	static Lanes4 set (double a, double b, double c, double d) noexcept { return { _mm_setr_pd (a, b), _mm_setr_pd (c, d) }; }
+
+	static Lanes4 load (const double* source) noexcept { return { _mm_loadu_pd (source), _mm_loadu_pd (source + 2) }; }
+
+	static Lanes4 gather (const double* const* channels, int index) noexcept
+	{
+		return { _mm_setr_pd (channels[0][index], channels[1][index]),
+				 _mm_setr_pd (channels[2][index], channels[3][index]) };
+	}
+
+	void scatter (double* const* channels, int index) const noexcept
+	{
+		_mm_storel_pd (channels[0] + index, lo);
+		_mm_storeh_pd (channels[1] + index, lo);
+		_mm_storel_pd (channels[2] + index, hi);
+		_mm_storeh_pd (channels[3] + index, hi);
+	}
+
+	void store (double* dest) const noexcept
+	{
+		_mm_storeu_pd (dest, lo);
+		_mm_storeu_pd (dest + 2, hi);
+	}
+
+	friend Lanes4 operator+ (const Lanes4& a, const Lanes4& b) noexcept { return { _mm_add_pd (a.lo, b.lo), _mm_add_pd (a.hi, b.hi) }; }
+	friend Lanes4 operator- (const Lanes4& a, const Lanes4& b) noexcept { return { _mm_sub_pd (a.lo, b.lo), _mm_sub_pd (a.hi, b.hi) }; }
+	friend Lanes4 operator* (const Lanes4& a, const Lanes4& b) noexcept { return { _mm_mul_pd (a.lo, b.lo), _mm_mul_pd (a.hi, b.hi) }; }
+
+	friend Lanes4 max (const Lanes4& a, const Lanes4& b) noexcept { return { _mm_max_pd (a.lo, b.lo), _mm_max_pd (a.hi, b.hi) }; }
+
+	friend Lanes4 abs (const Lanes4& a) noexcept
+	{
+		const auto signBit = _mm_set1_pd (-0.);
+		return { _mm_andnot_pd (signBit, a.lo), _mm_andnot_pd (signBit, a.hi) };
+	}
+
+	__m128d lo, hi;
+};
+
+#	endif
+#endif
+
+}  // namespace Imogen
@@ -0,0 +1,45 @@
+
+namespace Imogen
+{
+template <typename SampleType>
+bool isSilent (const SampleType* samples, int numSamples) noexcept
+{
+	static const auto threshold = juce::Decibels::decibelsToGain (static_cast<SampleType> (silenceThresholdDb));
+
+	const auto range = juce::FloatVectorOperations::findMinAndMax (samples, numSamples);
+
+	return range.getStart() > -threshold && range.getEnd() < threshold;
+}
+
+template <typename SampleType>
+bool isSilent (const juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+	for (auto chan = 0; chan < buffer.getNumChannels(); ++chan)
+		if (! isSilent (buffer.getReadPointer (chan), buffer.getNumSamples()))
+			return false;
+
+	return true;
+}
+
+template bool isSilent (const float*, int) noexcept;
+template bool isSilent (const double*, int) noexcept;
+template bool isSilent (const juce::AudioBuffer<float>&) noexcept;
+template bool isSilent (const juce::AudioBuffer<double>&) noexcept;
+
+/*------------------------------------------------------------------------------------------*/
+
+void TailTracker::prepare (double samplerate, double holdSeconds)
+{
+	holdSamples = std::max (juce::int64 (1), static_cast<juce::int64> (samplerate * holdSeconds));
+	reset();
+}
+
+void TailTracker::update (bool inputAndOutputWereSilent, int numSamples) noexcept
+{
+	if (inputAndOutputWereSilent)
+		silentSamples = std::min (silentSamples + numSamples, holdSamples);
+	else
+		silentSamples = 0;
+}
+
+}  // namespace Imogen
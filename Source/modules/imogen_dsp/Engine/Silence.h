@@ -0,0 +1,42 @@
+#pragma once
+
+namespace Imogen
+{
+/* Anything quieter than this is treated as digital silence. */
+static constexpr auto silenceThresholdDb = -100.f;
+
+/* How long filters and other short-memory stages are left running after their input goes silent. */
+static constexpr auto filterTailSeconds = 0.05;
+
+template <typename SampleType>
+bool isSilent (const SampleType* samples, int numSamples) noexcept;
+
+template <typename SampleType>
+bool isSilent (const juce::AudioBuffer<SampleType>& buffer) noexcept;
+
+
+/* Decides when a stage can stop processing silence. A stage is idle once both its input and its
+   output have been silent for at least the hold time, which should cover any delay between the
+   two (such as a delay line that hasn't played its last echo yet). Until then, the stage keeps
+   running so that its tail rings out.
+ */
+class TailTracker
+{
+public:
+
+	void prepare (double samplerate, double holdSeconds);
+
+	void reset() noexcept { silentSamples = 0; }
+
+	/* Call after processing a block. */
+	void update (bool inputAndOutputWereSilent, int numSamples) noexcept;
+
+	/* True if the stage can skip the next block, provided its input for that block is silent. */
+	bool isIdle() const noexcept { return silentSamples >= holdSamples; }
+
+private:
+
+	juce::int64 holdSamples { 1 }, silentSamples { 0 };
+};
+
+}  // namespace Imogen
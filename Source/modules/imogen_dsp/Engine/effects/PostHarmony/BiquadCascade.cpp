@@ -0,0 +1,204 @@
+
+namespace Imogen
+{
+template <typename SampleType>
+BiquadCascade<SampleType>::BiquadCascade (int numStagesToUse)
+	: stages (static_cast<size_t> (numStagesToUse))
+{
+	for (auto i = 0; i < numStagesToUse; ++i)
+		setCoefficients (i, {});
+
+	reset();
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::setCoefficients (int stage, const Coefficients& coefs) noexcept
+{
+	auto& s = stages[static_cast<size_t> (stage)];
+
+	s.b0 = Lanes::broadcast (static_cast<SampleType> (coefs.b0));
+	s.b1 = Lanes::broadcast (static_cast<SampleType> (coefs.b1));
+	s.b2 = Lanes::broadcast (static_cast<SampleType> (coefs.b2));
+	s.a1 = Lanes::broadcast (static_cast<SampleType> (coefs.a1));
+	s.a2 = Lanes::broadcast (static_cast<SampleType> (coefs.a2));
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::reset() noexcept
+{
+	for (auto& stage : stages)
+	{
+		stage.z1 = Lanes::broadcast (SampleType (0));
+		stage.z2 = Lanes::broadcast (SampleType (0));
+	}
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::reset (int stage) noexcept
+{
+	auto& s = stages[static_cast<size_t> (stage)];
+
+	s.z1 = Lanes::broadcast (SampleType (0));
+	s.z2 = Lanes::broadcast (SampleType (0));
+}
+
+template <typename SampleType>
+template <typename IOType>
+void BiquadCascade<SampleType>::process (const std::array<IOType*, numChannels>& channels, int numSamples) noexcept
+{
+	auto* const* chans = channels.data();
+
+	const auto load = [chans] (int i)
+	{
+		if constexpr (std::is_same_v<IOType, SampleType>)
+			return Lanes::gather (chans, i);
+		else
+			return Lanes::set (static_cast<SampleType> (chans[0][i]), static_cast<SampleType> (chans[1][i]),
+							   static_cast<SampleType> (chans[2][i]), static_cast<SampleType> (chans[3][i]));
+	};
+
+	const auto save = [chans] (const Lanes& y, int i)
+	{
+		if constexpr (std::is_same_v<IOType, SampleType>)
+		{
+			y.scatter (chans, i);
+		}
+		else
+		{
+			std::array<SampleType, numChannels> out;
+			y.store (out.data());
+
+			for (auto chan = 0; chan < numChannels; ++chan)
+				chans[chan][i] = static_cast<IOType> (out[static_cast<size_t> (chan)]);
+		}
+	};
+
+	for (auto i = 0; i < numSamples; ++i)
+	{
+		auto x = load (i);
+
+		for (auto& s : stages)
+		{
+			const auto y = s.b0 * x + s.z1;
+
+			s.z1 = s.b1 * x - s.a1 * y + s.z2;
+			s.z2 = s.b2 * x - s.a2 * y;
+
+			x = y;
+		}
+
+		save (x, i);
+	}
+}
+
+/*------------------------------------------------------------------------------------------*/
+
+// these are the designs from Robert Bristow-Johnson's Audio EQ Cookbook
+
+struct BiquadDesign
+{
+	BiquadDesign (double samplerate, float freq, float Q, float gain)
+	{
+		const auto w0 = juce::MathConstants<double>::twoPi * juce::jlimit (1., samplerate * 0.49, static_cast<double> (freq)) / samplerate;
+
+		cosw  = std::cos (w0);
+		alpha = std::sin (w0) / (2. * std::max (0.01, static_cast<double> (Q)));
+		A	  = std::sqrt (std::max (0.001, static_cast<double> (gain)));
+	}
+
+	template <typename Coefs>
+	static Coefs normalise (double b0, double b1, double b2, double a0, double a1, double a2) noexcept
+	{
+		Coefs c;
+
+		c.b0 = b0 / a0;
+		c.b1 = b1 / a0;
+		c.b2 = b2 / a0;
+		c.a1 = a1 / a0;
+		c.a2 = a2 / a0;
+
+		return c;
+	}
+
+	double cosw, alpha, A;
+};
+
+template <typename SampleType>
+typename BiquadCascade<SampleType>::Coefficients BiquadCascade<SampleType>::Coefficients::makeLowShelf (double samplerate, float freq, float Q, float gain) noexcept
+{
+	const BiquadDesign d { samplerate, freq, Q, gain };
+
+	const auto A	= d.A;
+	const auto beta = 2. * std::sqrt (A) * d.alpha;
+
+	return BiquadDesign::normalise<Coefficients> (A * ((A + 1.) - (A - 1.) * d.cosw + beta),
+												  2. * A * ((A - 1.) - (A + 1.) * d.cosw),
+												  A * ((A + 1.) - (A - 1.) * d.cosw - beta),
+												  (A + 1.) + (A - 1.) * d.cosw + beta,
+												  -2. * ((A - 1.) + (A + 1.) * d.cosw),
+												  (A + 1.) + (A - 1.) * d.cosw - beta);
+}
+
+template <typename SampleType>
+typename BiquadCascade<SampleType>::Coefficients BiquadCascade<SampleType>::Coefficients::makeHighShelf (double samplerate, float freq, float Q, float gain) noexcept
+{
+	const BiquadDesign d { samplerate, freq, Q, gain };
+
+	const auto A	= d.A;
+	const auto beta = 2. * std::sqrt (A) * d.alpha;
+
+	return BiquadDesign::normalise<Coefficients> (A * ((A + 1.) + (A - 1.) * d.cosw + beta),
+												  -2. * A * ((A - 1.) + (A + 1.) * d.cosw),
+												  A * ((A + 1.) + (A - 1.) * d.cosw - beta),
+												  (A + 1.) - (A - 1.) * d.cosw + beta,
+												  2. * ((A - 1.) - (A + 1.) * d.cosw),
+												  (A + 1.) - (A - 1.) * d.cosw - beta);
+}
+
+template <typename SampleType>
+typename BiquadCascade<SampleType>::Coefficients BiquadCascade<SampleType>::Coefficients::makeHighPass (double samplerate, float freq, float Q) noexcept
+{
+	const BiquadDesign d { samplerate, freq, Q, 1.f };
+
+	return BiquadDesign::normalise<Coefficients> ((1. + d.cosw) * 0.5,
+												  -(1. + d.cosw),
+												  (1. + d.cosw) * 0.5,
+												  1. + d.alpha,
+												  -2. * d.cosw,
+												  1. - d.alpha);
+}
+
+template <typename SampleType>
+typename BiquadCascade<SampleType>::Coefficients BiquadCascade<SampleType>::Coefficients::makeLowPass (double samplerate, float freq, float Q) noexcept
+{
+	const BiquadDesign d { samplerate, freq, Q, 1.f };
+
+	return BiquadDesign::normalise<Coefficients> ((1. - d.cosw) * 0.5,
+												  1. - d.cosw,
+												  (1. - d.cosw) * 0.5,
+												  1. + d.alpha,
+												  -2. * d.cosw,
+												  1. - d.alpha);
+}
+
+template <typename SampleType>
+typename BiquadCascade<SampleType>::Coefficients BiquadCascade<SampleType>::Coefficients::makePeak (double samplerate, float freq, float Q, float gain) noexcept
+{
+	const BiquadDesign d { samplerate, freq, Q, gain };
+
+	return BiquadDesign::normalise<Coefficients> (1. + d.alpha * d.A,
+												  -2. * d.cosw,
+												  1. - d.alpha * d.A,
+												  1. + d.alpha / d.A,
+												  -2. * d.cosw,
+												  1. - d.alpha / d.A);
+}
+
+template class BiquadCascade<float>;
+template class BiquadCascade<double>;
+
+template void BiquadCascade<float>::process (const std::array<float*, numChannels>&, int) noexcept;
+template void BiquadCascade<double>::process (const std::array<double*, numChannels>&, int) noexcept;
+template void BiquadCascade<double>::process (const std::array<float*, numChannels>&, int) noexcept;
+
+}  // namespace Imogen
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <imogen_dsp/Engine/SIMD.h>
+
+namespace Imogen
+{
+/* A chain of biquads that runs four channels at once, one per SIMD lane, with every channel
+   sharing the same coefficients. Each stage is in transposed direct form II.
+   The audio may be in a different type from the filter's own, so that a float signal can be
+   filtered in double where the extra precision matters.
+ */
+template <typename SampleType>
+class BiquadCascade
+{
+public:
+
+	static constexpr auto numChannels = 4;
+
+	struct Coefficients
+	{
+		static Coefficients makeLowShelf (double samplerate, float freq, float Q, float gain) noexcept;
+		static Coefficients makeHighShelf (double samplerate, float freq, float Q, float gain) noexcept;
+		static Coefficients makeHighPass (double samplerate, float freq, float Q) noexcept;
+		static Coefficients makeLowPass (double samplerate, float freq, float Q) noexcept;
+		static Coefficients makePeak (double samplerate, float freq, float Q, float gain) noexcept;
+
+		// normalised so that a0 is 1; the default passes audio through unchanged
+		double b0 { 1. }, b1 { 0. }, b2 { 0. }, a1 { 0. }, a2 { 0. };
+	};
+
+	explicit BiquadCascade (int numStagesToUse);
+
+	void setCoefficients (int stage, const Coefficients& coefs) noexcept;
+
+	void reset() noexcept;
+	void reset (int stage) noexcept;
+
+	template <typename IOType>
+	void process (const std::array<IOType*, numChannels>& channels, int numSamples) noexcept;
+
+private:
+
+	using Lanes = Lanes4<SampleType>;
+
+	struct Stage
+	{
+		Lanes b0, b1, b2, a1, a2;
+		Lanes z1, z2;
+	};
+
+	std::vector<Stage> stages;
+};
+
+}  // namespace Imogen
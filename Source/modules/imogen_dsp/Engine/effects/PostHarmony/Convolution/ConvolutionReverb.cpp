@@ -0,0 +1,253 @@
+
+namespace Imogen
+{
+ConvolutionReverb::ConvolutionReverb (CustomStateData& dataToUse)
+	: data (dataToUse)
+{
+}
+
+ConvolutionReverb::~ConvolutionReverb()
+{
+	stopTimer();
+
+	finishTailJob();
+
+	worker.signalThreadShouldExit();
+	jobState.store (stopping);
+	jobState.notify_all();
+	worker.stopThread (1000);
+
+	loader.stopThread (1000);
+
+	delete pending.exchange (nullptr);
+	delete retired.exchange (nullptr);
+}
+
+void ConvolutionReverb::prepare (double newSamplerate)
+{
+	reset();
+
+	if (newSamplerate == samplerate.load())
+		return;
+
+	active.reset();
+	delete pending.exchange (nullptr);
+
+	samplerate.store (newSamplerate);
+	loader.notify();
+}
+
+void ConvolutionReverb::startThreads()
+{
+	if (threadsStarted.exchange (true))
+		return;
+
+	worker.startThread (juce::Thread::realtimeAudioPriority);
+	loader.startThread (2);
+}
+
+void ConvolutionReverb::timerCallback()
+{
+	stopTimer();
+	startThreads();
+}
+
+void ConvolutionReverb::update() noexcept
+{
+	if (! threadsStarted.load (std::memory_order_relaxed) && ! threadsWanted.exchange (true, std::memory_order_relaxed))
+		startTimerHz (10);
+
+	// with no response loaded there are no tail jobs, so a new one can be swapped in straight away
+	if (active == nullptr || ! active->hasImpulseResponse())
+		swapInPendingConvolver();
+}
+
+/* Only the active convolver is looked at: a pending one belongs to the loader until it's swapped in. */
+bool ConvolutionReverb::isReady() const noexcept
+{
+	return active != nullptr && active->hasImpulseResponse();
+}
+
+void ConvolutionReverb::reset() noexcept
+{
+	finishTailJob();
+
+	jobState.store (idle, std::memory_order_relaxed);
+
+	if (active != nullptr)
+		active->reset();
+}
+
+void ConvolutionReverb::process (float* const* channels, int numSamples) noexcept
+{
+	for (auto done = 0; done < numSamples;)
+	{
+		if (active == nullptr || ! active->hasImpulseResponse())
+		{
+			for (auto chan = 0; chan < ImpulseResponse::numChannels; ++chan)
+				std::fill_n (channels[chan] + done, numSamples - done, 0.f);
+
+			return;
+		}
+
+		const auto chunk = std::min (numSamples - done, active->getSamplesUntilTailBoundary());
+
+		const std::array<float*, ImpulseResponse::numChannels> offset { channels[0] + done, channels[1] + done };
+
+		active->process (offset.data(), chunk);
+
+		done += chunk;
+
+		if (active->isAtTailBoundary())
+		{
+			finishTailJob();
+
+			active->collectTail();
+
+			swapInPendingConvolver();
+
+			startTailJob();
+		}
+	}
+}
+
+void ConvolutionReverb::finishTailJob() noexcept
+{
+	auto expected = static_cast<int> (posted);
+
+	// if the worker hasn't picked the job up yet, it is quicker to just run it here
+	if (jobState.compare_exchange_strong (expected, running, std::memory_order_acquire))
+	{
+		jobTarget->renderTail();
+		jobState.store (done, std::memory_order_release);
+		return;
+	}
+
+	while (jobState.load (std::memory_order_acquire) == running)
+		std::this_thread::yield();
+}
+
+void ConvolutionReverb::startTailJob() noexcept
+{
+	if (active == nullptr || ! active->hasTail())
+	{
+		jobState.store (idle, std::memory_order_relaxed);
+		return;
+	}
+
+	active->startTail();
+
+	jobTarget = active.get();
+
+	jobState.store (posted, std::memory_order_release);
+	jobState.notify_one();
+}
+
+void ConvolutionReverb::swapInPendingConvolver() noexcept
+{
+	if (pending.load (std::memory_order_relaxed) == nullptr)
+		return;
+
+	// the loader frees the old convolver; if it hasn't got round to the last one yet, try again next boundary
+	if (retired.load (std::memory_order_acquire) != nullptr)
+		return;
+
+	std::unique_ptr<PartitionedConvolver> next { pending.exchange (nullptr, std::memory_order_acq_rel) };
+
+	if (next == nullptr)
+		return;
+
+	// a response that finished loading just after the samplerate changed is thrown away
+	if (const auto* response = next->getImpulseResponse())
+	{
+		if (response->samplerate != samplerate.load (std::memory_order_relaxed))
+		{
+			retired.store (next.release(), std::memory_order_release);
+			return;
+		}
+	}
+
+	retired.store (active.release(), std::memory_order_release);
+	active = std::move (next);
+}
+
+/*------------------------------------------------------------------------------------------*/
+
+ConvolutionReverb::TailWorker::TailWorker (ConvolutionReverb& ownerToUse)
+	: juce::Thread ("Imogen reverb tail"), owner (ownerToUse)
+{
+}
+
+void ConvolutionReverb::TailWorker::run()
+{
+	auto& state = owner.jobState;
+
+	while (! threadShouldExit())
+	{
+		auto expected = static_cast<int> (posted);
+
+		if (state.load (std::memory_order_relaxed) == stopping)
+			return;
+
+		if (state.compare_exchange_strong (expected, running, std::memory_order_acquire))
+		{
+			owner.jobTarget->renderTail();
+			state.store (done, std::memory_order_release);
+			continue;
+		}
+
+		state.wait (expected, std::memory_order_acquire);
+	}
+}
+
+/*------------------------------------------------------------------------------------------*/
+
+ConvolutionReverb::Loader::Loader (ConvolutionReverb& ownerToUse)
+	: juce::Thread ("Imogen impulse response loader"), owner (ownerToUse)
+{
+}
+
+void ConvolutionReverb::Loader::run()
+{
+	while (! threadShouldExit())
+	{
+		delete owner.retired.exchange (nullptr, std::memory_order_acq_rel);
+
+		checkForNewResponse();
+
+		wait (100);
+	}
+}
+
+void ConvolutionReverb::Loader::checkForNewResponse()
+{
+	const auto samplerate = owner.samplerate.load();
+	const auto version	  = owner.data.getImpulseResponseVersion();
+
+	if (samplerate <= 0. || (version == loadedVersion && samplerate == loadedSamplerate))
+		return;
+
+	// the last convolver hasn't been swapped in yet, so this one is loaded once the audio thread has taken it
+	if (owner.pending.load (std::memory_order_acquire) != nullptr)
+		return;
+
+	loadedVersion	 = version;
+	loadedSamplerate = samplerate;
+
+	const auto file = owner.data.getImpulseResponse();
+
+	std::shared_ptr<const ImpulseResponse> response;
+
+	if (file.existsAsFile())
+		response = ImpulseResponse::load (file, samplerate);
+
+	auto convolver = std::make_unique<PartitionedConvolver> (std::move (response));
+
+	// only the audio thread takes convolvers out of the slot, so once it's empty it stays empty until this fills it
+	PartitionedConvolver* expected = nullptr;
+
+	if (owner.pending.compare_exchange_strong (expected, convolver.get(), std::memory_order_acq_rel))
+		convolver.release();
+}
+
+}  // namespace Imogen
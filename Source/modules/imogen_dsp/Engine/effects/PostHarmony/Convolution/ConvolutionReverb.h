@@ -0,0 +1,104 @@
+#pragma once
+
+#include "PartitionedConvolver.h"
+
+namespace Imogen
+{
+/* Runs a PartitionedConvolver on the audio thread, hands its tail jobs to a real-time worker
+   thread, and loads new impulse responses on a background thread whenever the one named in
+   the state changes.
+
+   Neither thread is started until convolution is first used, so reverbs that never use it
+   cost nothing. A newly loaded convolver is only swapped in at a tail boundary, when no job is
+   in flight, and the old one goes back to the loader thread to be freed.
+ */
+class ConvolutionReverb : private juce::Timer
+{
+public:
+
+	explicit ConvolutionReverb (CustomStateData& dataToUse);
+
+	~ConvolutionReverb() override;
+
+	/* Must not be called while audio is running. Responses are reloaded at the new samplerate. */
+	void prepare (double samplerate);
+
+	/* Starts the worker and loader threads, if they aren't running yet. Only call this from the
+	   message thread, or while audio isn't running.
+	 */
+	void startThreads();
+
+	/* Called by the audio thread whenever convolution is switched on, before isReady(). Swaps in a
+	   newly loaded response if none is playing yet. The first time, it starts a timer that starts
+	   the threads from the message thread. Starting the timer takes the timer thread's lock, but only
+	   once in the reverb's life, and a reverb that never uses convolution never polls.
+	 */
+	void update() noexcept;
+
+	/* True once an impulse response has been swapped in for the current samplerate. */
+	bool isReady() const noexcept;
+
+	void reset() noexcept;
+
+	/* Replaces a stereo signal with its convolution. */
+	void process (float* const* channels, int numSamples) noexcept;
+
+private:
+
+	enum JobState
+	{
+		idle,
+		posted,
+		running,
+		done,
+		stopping
+	};
+
+	void finishTailJob() noexcept;
+	void startTailJob() noexcept;
+	void swapInPendingConvolver() noexcept;
+
+	void timerCallback() final;
+
+	struct TailWorker : juce::Thread
+	{
+		TailWorker (ConvolutionReverb& ownerToUse);
+
+		void run() final;
+
+		ConvolutionReverb& owner;
+	};
+
+	struct Loader : juce::Thread
+	{
+		Loader (ConvolutionReverb& ownerToUse);
+
+		void run() final;
+
+		void checkForNewResponse();
+
+		ConvolutionReverb& owner;
+
+		int	   loadedVersion { -1 };
+		double loadedSamplerate { 0. };
+	};
+
+	CustomStateData& data;
+
+	std::unique_ptr<PartitionedConvolver> active;
+
+	std::atomic<PartitionedConvolver*> pending { nullptr }, retired { nullptr };
+
+	std::atomic<double> samplerate { 0. };
+
+	std::atomic<bool> threadsStarted { false }, threadsWanted { false };
+
+	// the convolver whose tail job is posted is only written while no job is in flight
+	PartitionedConvolver* jobTarget { nullptr };
+	std::atomic<int>	  jobState { idle };
+
+	TailWorker worker { *this };
+	Loader	   loader { *this };
+};
+
+}  // namespace Imogen
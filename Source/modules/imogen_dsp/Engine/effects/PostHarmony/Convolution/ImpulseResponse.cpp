@@ -0,0 +1,283 @@
+
+namespace Imogen
+{
+/* Streams an audio file from a memory map, resampled to the engine's rate, without ever holding
+   more than one chunk of it in memory.
+ */
+class ImpulseResponseReader
+{
+public:
+
+	bool open (const juce::File& file, double targetSamplerate)
+	{
+		juce::WavAudioFormat wav;
+
+		if (auto* mapped = wav.createMemoryMappedReader (file))
+		{
+			mapped->mapEntireFile();
+
+			if (mapped->getMappedSection().isEmpty())
+				delete mapped;
+			else
+				reader.reset (mapped);
+		}
+
+		if (reader == nullptr)
+		{
+			// other formats don't support memory mapping, so read them in the normal way
+			juce::AudioFormatManager formats;
+			formats.registerBasicFormats();
+
+			reader.reset (formats.createReaderFor (file));
+		}
+
+		if (reader == nullptr || reader->lengthInSamples <= 0 || reader->sampleRate <= 0.)
+			return false;
+
+		ratio = reader->sampleRate / targetSamplerate;
+
+		const auto maxLength = static_cast<juce::int64> (ImpulseResponse::maxSeconds * targetSamplerate);
+
+		lengthInSamples = std::min (maxLength, static_cast<juce::int64> (static_cast<double> (reader->lengthInSamples) / ratio));
+
+		sourceChunk.setSize (ImpulseResponse::numChannels, chunkSize);
+		rewind();
+
+		return true;
+	}
+
+	void rewind()
+	{
+		sourcePosition = 0;
+		numBuffered	   = 0;
+		padded		   = false;
+
+		for (auto& interpolator : interpolators)
+			interpolator.reset();
+	}
+
+	juce::int64 getLengthInSamples() const noexcept { return lengthInSamples; }
+
+	/* Reads the next numSamples at the target rate into both channels, zero-padding past the end. */
+	void readNext (float* const* dest, int numSamples)
+	{
+		for (auto done = 0; done < numSamples;)
+		{
+			fillSource();
+
+			// the interpolators look a few samples ahead of the ones they consume
+			const auto todo = std::min (numSamples - done, static_cast<int> (static_cast<double> (numBuffered - 4) / ratio));
+
+			if (todo <= 0)
+			{
+				for (auto chan = 0; chan < ImpulseResponse::numChannels; ++chan)
+					std::fill_n (dest[chan] + done, numSamples - done, 0.f);
+
+				return;
+			}
+
+			auto used = 0;
+
+			for (auto chan = 0; chan < ImpulseResponse::numChannels; ++chan)
+				used = interpolators[static_cast<size_t> (chan)].process (ratio, sourceChunk.getReadPointer (chan), dest[chan] + done, todo);
+
+			for (auto chan = 0; chan < ImpulseResponse::numChannels; ++chan)
+				std::copy (sourceChunk.getReadPointer (chan) + used, sourceChunk.getReadPointer (chan) + numBuffered, sourceChunk.getWritePointer (chan));
+
+			numBuffered -= used;
+			done += todo;
+		}
+	}
+
+private:
+
+	void fillSource()
+	{
+		const auto space = sourceChunk.getNumSamples() - numBuffered;
+
+		if (space <= 0)
+			return;
+
+		const auto numToRead = static_cast<int> (std::min (static_cast<juce::int64> (space), reader->lengthInSamples - sourcePosition));
+
+		if (numToRead <= 0)
+		{
+			// pad past the end so that the interpolators can flush
+			if (! padded)
+			{
+				for (auto chan = 0; chan < ImpulseResponse::numChannels; ++chan)
+					juce::FloatVectorOperations::clear (sourceChunk.getWritePointer (chan, numBuffered), std::min (space, 8));
+
+				numBuffered += std::min (space, 8);
+				padded = true;
+			}
+
+			return;
+		}
+
+		const auto mono = reader->numChannels == 1;
+
+		juce::AudioBuffer<float> dest { sourceChunk.getArrayOfWritePointers(), ImpulseResponse::numChannels, numBuffered, numToRead };
+
+		reader->read (&dest, 0, numToRead, sourcePosition, true, ! mono);
+
+		if (mono)
+			dest.copyFrom (1, 0, dest, 0, 0, numToRead);
+
+		sourcePosition += numToRead;
+		numBuffered += numToRead;
+	}
+
+	static constexpr auto chunkSize = 4096;
+
+	std::unique_ptr<juce::AudioFormatReader> reader;
+
+	double		ratio { 1. };
+	juce::int64 lengthInSamples { 0 }, sourcePosition { 0 };
+
+	juce::AudioBuffer<float> sourceChunk;
+	int						 numBuffered { 0 };
+	bool					 padded { false };
+
+	std::array<juce::LagrangeInterpolator, ImpulseResponse::numChannels> interpolators;
+};
+
+/*------------------------------------------------------------------------------------------*/
+
+static std::shared_ptr<const ImpulseResponse> createImpulseResponse (const juce::File& file, double samplerate)
+{
+	ImpulseResponseReader reader;
+
+	if (! reader.open (file, samplerate))
+		return nullptr;
+
+	constexpr auto numChannels = ImpulseResponse::numChannels;
+	constexpr auto headSize	   = ImpulseResponse::headSize;
+	constexpr auto tailSize	   = ImpulseResponse::tailSize;
+
+	const auto length = reader.getLengthInSamples();
+
+	juce::AudioBuffer<float> chunk { numChannels, tailSize };
+
+	// normalise to unit energy in the louder channel, which needs one pass over the whole file first
+	std::array<double, numChannels> energy {};
+
+	for (juce::int64 pos = 0; pos < length; pos += tailSize)
+	{
+		reader.readNext (chunk.getArrayOfWritePointers(), tailSize);
+
+		const auto numValid = static_cast<int> (std::min (static_cast<juce::int64> (tailSize), length - pos));
+
+		for (auto chan = 0; chan < numChannels; ++chan)
+			for (auto i = 0; i < numValid; ++i)
+				energy[static_cast<size_t> (chan)] += juce::square (static_cast<double> (chunk.getSample (chan, i)));
+	}
+
+	const auto maxEnergy = *std::max_element (energy.begin(), energy.end());
+
+	if (maxEnergy <= 0.)
+		return nullptr;
+
+	const auto gain = static_cast<float> (1. / std::sqrt (maxEnergy));
+
+	auto ir = std::make_shared<ImpulseResponse>();
+
+	ir->samplerate		= samplerate;
+	ir->lengthInSamples = length;
+	ir->numHeadParts	= (ImpulseResponse::tailPartsStart - ImpulseResponse::headPartsStart) / headSize;
+	ir->numTailParts	= static_cast<int> ((std::max (juce::int64 (0), length - ImpulseResponse::tailPartsStart) + tailSize - 1) / tailSize);
+
+	juce::dsp::FFT headFFT { juce::roundToInt (std::log2 (2 * headSize)) };
+	juce::dsp::FFT tailFFT { juce::roundToInt (std::log2 (2 * tailSize)) };
+
+	std::vector<float> scratch;
+
+	for (auto& channel : ir->channels)
+	{
+		channel.directTaps.resize (static_cast<size_t> (headSize));
+		channel.headSpectra.resize (static_cast<size_t> (ir->numHeadParts * (headSize + 1)));
+		channel.tailSpectra.resize (static_cast<size_t> (ir->numTailParts * (tailSize + 1)));
+	}
+
+	reader.rewind();
+
+	// everything before the tail partitions is read in one go, then the tail one partition at a time
+	{
+		juce::AudioBuffer<float> front { numChannels, ImpulseResponse::tailPartsStart };
+		reader.readNext (front.getArrayOfWritePointers(), front.getNumSamples());
+		front.applyGain (gain);
+
+		for (auto chan = 0; chan < numChannels; ++chan)
+		{
+			auto& channel = ir->channels[static_cast<size_t> (chan)];
+
+			const auto* samples = front.getReadPointer (chan);
+
+			std::copy_n (samples, headSize, channel.directTaps.data());
+
+			for (auto part = 0; part < ir->numHeadParts; ++part)
+				ImpulseResponse::transform (samples + ImpulseResponse::headPartsStart + part * headSize, headSize, headSize,
+											headFFT, scratch, channel.headSpectra.data() + part * (headSize + 1));
+		}
+	}
+
+	for (auto part = 0; part < ir->numTailParts; ++part)
+	{
+		reader.readNext (chunk.getArrayOfWritePointers(), tailSize);
+		chunk.applyGain (gain);
+
+		for (auto chan = 0; chan < numChannels; ++chan)
+			ImpulseResponse::transform (chunk.getReadPointer (chan), tailSize, tailSize, tailFFT, scratch,
+										ir->channels[static_cast<size_t> (chan)].tailSpectra.data() + part * (tailSize + 1));
+	}
+
+	return ir;
+}
+
+std::shared_ptr<const ImpulseResponse> ImpulseResponse::load (const juce::File& file, double samplerate)
+{
+	// instances that load the same file share it, for as long as any of them is still using it
+	static std::mutex													  cacheLock;
+	static std::map<String, std::weak_ptr<const ImpulseResponse>> cache;
+
+	const auto key = file.getFullPathName() + "|" + String (file.getLastModificationTime().toMilliseconds()) + "|" + String (samplerate);
+
+	{
+		const std::lock_guard<std::mutex> lock { cacheLock };
+
+		if (auto existing = cache[key].lock())
+			return existing;
+	}
+
+	auto ir = createImpulseResponse (file, samplerate);
+
+	if (ir != nullptr)
+	{
+		const std::lock_guard<std::mutex> lock { cacheLock };
+
+		for (auto it = cache.begin(); it != cache.end();)
+		{
+			if (it->second.expired())
+				it = cache.erase (it);
+			else
+				++it;
+		}
+
+		cache[key] = ir;
+	}
+
+	return ir;
+}
+
+void ImpulseResponse::transform (const float* segment, int length, int blockSize, juce::dsp::FFT& fft, std::vector<float>& scratch, Complex* dest)
+{
+	scratch.assign (static_cast<size_t> (4 * blockSize), 0.f);
+
+	std::copy_n (segment, length, scratch.data());
+
+	fft.performRealOnlyForwardTransform (scratch.data(), true);
+
+	std::copy_n (reinterpret_cast<const Complex*> (scratch.data()), blockSize + 1, dest);
+}
+
+}  // namespace Imogen
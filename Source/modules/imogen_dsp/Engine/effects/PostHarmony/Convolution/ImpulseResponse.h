@@ -0,0 +1,43 @@
+#pragma once
+
+namespace Imogen
+{
+/* An impulse response, cut into partitions and transformed ready for partitioned convolution.
+   It is immutable once loaded, and every convolver that uses the same file at the same
+   samplerate shares a single copy.
+
+   The first headSize samples are convolved directly, the rest of the first 2 * tailSize samples
+   in partitions of headSize, and everything after that in partitions of tailSize.
+ */
+struct ImpulseResponse
+{
+	static constexpr auto headSize		 = 64;
+	static constexpr auto tailSize		 = 2048;
+	static constexpr auto maxSeconds	 = 20.;
+	static constexpr auto numChannels	 = 2;
+	static constexpr auto headPartsStart = headSize;
+	static constexpr auto tailPartsStart = 2 * tailSize;
+
+	using Complex = std::complex<float>;
+
+	/* Returns nullptr if the file can't be read. Must not be called from the audio thread. */
+	static std::shared_ptr<const ImpulseResponse> load (const juce::File& file, double samplerate);
+
+	/* Zero-pads a segment to twice the block size and writes its spectrum, of blockSize + 1 bins. */
+	static void transform (const float* segment, int length, int blockSize, juce::dsp::FFT& fft, std::vector<float>& scratch, Complex* dest);
+
+	struct Channel
+	{
+		std::vector<float>	 directTaps;
+		std::vector<Complex> headSpectra, tailSpectra;
+	};
+
+	std::array<Channel, numChannels> channels;
+
+	int numHeadParts { 0 }, numTailParts { 0 };
+
+	juce::int64 lengthInSamples { 0 };
+	double		samplerate { 0. };
+};
+
+}  // namespace Imogen
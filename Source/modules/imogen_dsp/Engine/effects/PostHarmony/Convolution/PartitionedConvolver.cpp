@@ -0,0 +1,201 @@
+
+namespace Imogen
+{
+UniformConvolver::UniformConvolver (int blockSizeToUse, int numPartsToUse)
+	: blockSize (blockSizeToUse), numParts (numPartsToUse), numBins (blockSizeToUse + 1),
+	  fft (juce::roundToInt (std::log2 (2 * blockSizeToUse)))
+{
+	inputBlocks.resize (static_cast<size_t> (2 * blockSize));
+	scratch.resize (static_cast<size_t> (4 * blockSize));
+	delayLine.resize (static_cast<size_t> (std::max (1, numParts) * numBins));
+	accumulator.resize (static_cast<size_t> (numBins));
+
+	reset();
+}
+
+void UniformConvolver::reset() noexcept
+{
+	std::fill (inputBlocks.begin(), inputBlocks.end(), 0.f);
+	std::fill (delayLine.begin(), delayLine.end(), Complex {});
+
+	delayLinePos = 0;
+}
+
+void UniformConvolver::process (const float* input, const Complex* partitions, float* output) noexcept
+{
+	if (numParts == 0)
+	{
+		std::fill_n (output, blockSize, 0.f);
+		return;
+	}
+
+	// each transform covers the previous block and this one; only the second half survives overlap-save
+	std::copy_n (inputBlocks.data() + blockSize, blockSize, inputBlocks.data());
+	std::copy_n (input, blockSize, inputBlocks.data() + blockSize);
+
+	std::copy (inputBlocks.begin(), inputBlocks.end(), scratch.begin());
+	std::fill (scratch.begin() + 2 * blockSize, scratch.end(), 0.f);
+
+	fft.performRealOnlyForwardTransform (scratch.data(), true);
+
+	delayLinePos = (delayLinePos + numParts - 1) % numParts;
+
+	std::copy_n (reinterpret_cast<const Complex*> (scratch.data()), numBins, delayLine.data() + delayLinePos * numBins);
+
+	// the newest spectrum meets the first partition, the oldest the last
+	std::fill (accumulator.begin(), accumulator.end(), Complex {});
+
+	for (auto part = 0; part < numParts; ++part)
+	{
+		const auto* x = delayLine.data() + ((delayLinePos + part) % numParts) * numBins;
+		const auto* h = partitions + part * numBins;
+
+		auto* acc = accumulator.data();
+
+		for (auto bin = 0; bin < numBins; ++bin)
+		{
+			const auto xr = x[bin].real(), xi = x[bin].imag();
+			const auto hr = h[bin].real(), hi = h[bin].imag();
+
+			acc[bin] += Complex { xr * hr - xi * hi, xr * hi + xi * hr };
+		}
+	}
+
+	std::fill (scratch.begin(), scratch.end(), 0.f);
+	std::copy (accumulator.begin(), accumulator.end(), reinterpret_cast<Complex*> (scratch.data()));
+
+	fft.performRealOnlyInverseTransform (scratch.data());
+
+	std::copy_n (scratch.data() + blockSize, blockSize, output);
+}
+
+/*------------------------------------------------------------------------------------------*/
+
+PartitionedConvolver::ChannelState::ChannelState (int numHeadParts, int numTailParts)
+	: head (headSize, numHeadParts), tail (tailSize, numTailParts)
+{
+	directInput.resize (static_cast<size_t> (2 * headSize));
+	headOutput.resize (static_cast<size_t> (headSize));
+	tailInput.resize (static_cast<size_t> (tailSize));
+	tailOutput.resize (static_cast<size_t> (tailSize));
+	jobInput.resize (static_cast<size_t> (tailSize));
+	jobOutput.resize (static_cast<size_t> (tailSize));
+}
+
+PartitionedConvolver::PartitionedConvolver (std::shared_ptr<const ImpulseResponse> responseToUse)
+	: response (std::move (responseToUse))
+{
+	if (response == nullptr)
+		return;
+
+	for (auto chan = 0; chan < ImpulseResponse::numChannels; ++chan)
+		channelStates.push_back (std::make_unique<ChannelState> (response->numHeadParts, response->numTailParts));
+
+	reset();
+}
+
+void PartitionedConvolver::reset() noexcept
+{
+	for (auto& state : channelStates)
+	{
+		state->head.reset();
+		state->tail.reset();
+
+		for (auto* v : { &state->directInput, &state->headOutput, &state->tailInput,
+						 &state->tailOutput, &state->jobInput, &state->jobOutput })
+			std::fill (v->begin(), v->end(), 0.f);
+	}
+
+	headPos = 0;
+	tailPos = 0;
+}
+
+void PartitionedConvolver::process (float* const* channels, int numSamples) noexcept
+{
+	jassert (hasImpulseResponse());
+	jassert (numSamples <= getSamplesUntilTailBoundary());
+
+	for (auto done = 0; done < numSamples;)
+	{
+		const auto chunk = std::min (numSamples - done, headSize - headPos);
+
+		for (auto chan = 0; chan < ImpulseResponse::numChannels; ++chan)
+		{
+			auto& s = *channelStates[static_cast<size_t> (chan)];
+
+			const auto* taps = response->channels[static_cast<size_t> (chan)].directTaps.data();
+
+			auto* audio = channels[chan] + done;
+
+			std::copy_n (audio, chunk, s.directInput.data() + headSize + headPos);
+			std::copy_n (audio, chunk, s.tailInput.data() + tailPos);
+
+			for (auto i = 0; i < chunk; ++i)
+			{
+				// directInput holds the previous head block followed by this one
+				const auto* x = s.directInput.data() + headSize + headPos + i;
+
+				auto sum = s.headOutput[static_cast<size_t> (headPos + i)] + s.tailOutput[static_cast<size_t> (tailPos + i)];
+
+				for (auto tap = 0; tap < headSize; ++tap)
+					sum += taps[tap] * x[-tap];
+
+				audio[i] = sum;
+			}
+		}
+
+		done += chunk;
+		headPos += chunk;
+		tailPos += chunk;
+
+		if (headPos == headSize)
+			processHeadBlock();
+	}
+}
+
+void PartitionedConvolver::processHeadBlock() noexcept
+{
+	for (auto chan = 0; chan < ImpulseResponse::numChannels; ++chan)
+	{
+		auto& s = *channelStates[static_cast<size_t> (chan)];
+
+		// the head partitions start one block into the response, so this block's output is next block's
+		s.head.process (s.directInput.data() + headSize, response->channels[static_cast<size_t> (chan)].headSpectra.data(),
+						s.headOutput.data());
+
+		std::copy_n (s.directInput.data() + headSize, headSize, s.directInput.data());
+	}
+
+	headPos = 0;
+}
+
+void PartitionedConvolver::collectTail() noexcept
+{
+	jassert (isAtTailBoundary());
+
+	// the job started a block ago covered the response from two tail blocks in, which lines
+	// its output up with the block that is about to start
+	for (auto& s : channelStates)
+		std::swap (s->tailOutput, s->jobOutput);
+
+	tailPos = 0;
+}
+
+void PartitionedConvolver::startTail() noexcept
+{
+	for (auto& s : channelStates)
+		std::swap (s->tailInput, s->jobInput);
+}
+
+void PartitionedConvolver::renderTail() noexcept
+{
+	for (auto chan = 0; chan < ImpulseResponse::numChannels; ++chan)
+	{
+		auto& s = *channelStates[static_cast<size_t> (chan)];
+
+		s.tail.process (s.jobInput.data(), response->channels[static_cast<size_t> (chan)].tailSpectra.data(),
+						s.jobOutput.data());
+	}
+}
+
+}  // namespace Imogen
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "ImpulseResponse.h"
+
+namespace Imogen
+{
+/* One channel of uniformly partitioned overlap-save convolution, in blocks of blockSize samples. */
+class UniformConvolver
+{
+public:
+
+	using Complex = ImpulseResponse::Complex;
+
+	UniformConvolver (int blockSizeToUse, int numPartsToUse);
+
+	void reset() noexcept;
+
+	/* Takes the next blockSize samples of input and writes the matching blockSize samples of output. */
+	void process (const float* input, const Complex* partitions, float* output) noexcept;
+
+private:
+
+	const int blockSize, numParts, numBins;
+
+	juce::dsp::FFT fft;
+
+	std::vector<float>	 inputBlocks, scratch;
+	std::vector<Complex> delayLine, accumulator;
+
+	int delayLinePos { 0 };
+};
+
+/*------------------------------------------------------------------------------------------*/
+
+/* Convolves a stereo signal with an impulse response without adding any latency.
+   The first taps are applied directly, the early part of the response in small partitions
+   on the audio thread, and the rest in large partitions by a tail job, which has a whole
+   tail block's worth of time to finish before its output is needed.
+
+   All memory is allocated in the constructor, so that a convolver for a new response can be
+   built on a background thread and handed to the audio thread ready to go.
+ */
+class PartitionedConvolver
+{
+public:
+
+	static constexpr auto headSize = ImpulseResponse::headSize;
+	static constexpr auto tailSize = ImpulseResponse::tailSize;
+
+	explicit PartitionedConvolver (std::shared_ptr<const ImpulseResponse> responseToUse);
+
+	bool hasImpulseResponse() const noexcept { return response != nullptr; }
+	bool hasTail() const noexcept { return response != nullptr && response->numTailParts > 0; }
+
+	const ImpulseResponse* getImpulseResponse() const noexcept { return response.get(); }
+
+	void reset() noexcept;
+
+	int getSamplesUntilTailBoundary() const noexcept { return tailSize - tailPos; }
+
+	/* Replaces the signal with the convolved signal. numSamples must not cross a tail boundary. */
+	void process (float* const* channels, int numSamples) noexcept;
+
+	bool isAtTailBoundary() const noexcept { return tailPos == tailSize; }
+
+	/* At a tail boundary, the owner first collects the finished tail job, then starts the next one.
+	   renderTail() is the job itself, and may run on any thread in between.
+	 */
+	void collectTail() noexcept;
+	void startTail() noexcept;
+	void renderTail() noexcept;
+
+private:
+
+	void processHeadBlock() noexcept;
+
+	using Channel = ImpulseResponse::Channel;
+
+	const std::shared_ptr<const ImpulseResponse> response;
+
+	struct ChannelState
+	{
+		ChannelState (int numHeadParts, int numTailParts);
+
+		UniformConvolver head, tail;
+
+		// the direct taps read back over the previous head block, so both are kept side by side
+		std::vector<float> directInput, headOutput;
+
+		std::vector<float> tailInput, tailOutput;
+		std::vector<float> jobInput, jobOutput;
+	};
+
+	std::vector<std::unique_ptr<ChannelState>> channelStates;
+
+	int headPos { 0 }, tailPos { 0 };
+};
+
+}  // namespace Imogen
@@ -9,26 +9,270 @@ Delay<SampleType>::Delay (State& stateToUse) : state (stateToUse)
 template <typename SampleType>
 void Delay<SampleType>::process (AudioBuffer& audio)
 {
-	if (parameters.delayToggle->get())
+	if (! parameters.delayToggle->get())
+		return;
+
+	if (parameters.changes.checkForChanges (lastVersion))
+		updateSettings();
+
+	updateDelayTime();
+
+	const auto numSamples		= audio.getNumSamples();
+	const auto numChannelsToUse = std::min (numChannels, audio.getNumChannels());
+
+	jassert (numSamples <= blocksize);
+
+	auto* const* channels = audio.getArrayOfWritePointers();
+
+	// every read must come from samples already in the line, so a block is split into chunks
+	// no longer than the shortest tap
+	for (auto done = 0; done < numSamples;)
+	{
+		const auto chunk = std::min (numSamples - done, static_cast<int> (getMaxChunkSize()));
+
+		processChunk (channels, numChannelsToUse, done, chunk);
+
+		done += chunk;
+	}
+
+	if (! telemetry.isActive())
+		return;
+
+	auto level = SampleType (0);
+
+	for (auto chan = 0; chan < numChannelsToUse; ++chan)
+		level = std::max (level, wet.getMagnitude (chan, 0, numSamples));
+
+	telemetry.reportEffectLevel (TelemetryRecord::delay, juce::Decibels::gainToDecibels (static_cast<float> (level), TelemetryRecord::floorDecibels));
+}
+
+template <typename SampleType>
+void Delay<SampleType>::processChunk (SampleType* const* channels, int numChannelsToUse, int start, int numSamples)
+{
+	const auto endDelay = std::abs (targetDelay - currentDelay) < SampleType (0.01)
+							? targetDelay
+							: targetDelay + (currentDelay - targetDelay) * std::pow (glideCoef, static_cast<SampleType> (numSamples));
+
+	if (modDepthSamples > 0)
+	{
+		// a quadrature oscillator gives every tap its own quarter-phase offset of the same LFO
+		for (auto i = 0; i < numSamples; ++i)
+		{
+			lfoSin[static_cast<size_t> (i)] = std::sin (lfoPhase);
+			lfoCos[static_cast<size_t> (i)] = std::cos (lfoPhase);
+
+			lfoPhase += lfoIncrement;
+		}
+
+		lfoPhase = std::fmod (lfoPhase, juce::MathConstants<SampleType>::twoPi);
+	}
+
+	for (auto chan = 0; chan < numChannelsToUse; ++chan)
+		juce::FloatVectorOperations::clear (wet.getWritePointer (chan, start), numSamples);
+
+	for (auto tap = 0; tap < numTaps; ++tap)
+	{
+		const auto fraction = static_cast<SampleType> (tap + 1) / static_cast<SampleType> (numTaps);
+
+		readTap (tap, numSamples, currentDelay * fraction, endDelay * fraction);
+
+		const auto gain = tapGains[static_cast<size_t> (tap)];
+		const auto pan	= tapPans[static_cast<size_t> (tap)];
+
+		for (auto chan = 0; chan < numChannelsToUse; ++chan)
+		{
+			// equal-power pan, which only matters for stereo output
+			const auto panGain = numChannelsToUse == 1 ? gain
+													   : gain * std::sqrt (SampleType (0.5) * (SampleType (1) + (chan == 0 ? -pan : pan)));
+
+			juce::FloatVectorOperations::addWithMultiply (wet.getWritePointer (chan, start), tapSignal.getReadPointer (chan), panGain, numSamples);
+		}
+	}
+
+	currentDelay = endDelay;
+
+	// the last tap, at the full delay time, is still in tapSignal and is what feeds back
+	std::array<const SampleType*, numChannels> input {};
+
+	for (auto chan = 0; chan < numChannelsToUse; ++chan)
+	{
+		auto* fb = tapSignal.getWritePointer (chan);
+
+		juce::FloatVectorOperations::multiply (fb, feedback, numSamples);
+		juce::FloatVectorOperations::add (fb, channels[chan] + start, numSamples);
+
+		input[static_cast<size_t> (chan)] = fb;
+	}
+
+	write (input.data(), numChannelsToUse, numSamples);
+
+	for (auto chan = 0; chan < numChannelsToUse; ++chan)
+	{
+		auto* audio = channels[chan] + start;
+
+		juce::FloatVectorOperations::multiply (audio, SampleType (1) - mix, numSamples);
+		juce::FloatVectorOperations::addWithMultiply (audio, wet.getReadPointer (chan, start), mix, numSamples);
+	}
+}
+
+template <typename SampleType>
+void Delay<SampleType>::readTap (int tap, int numSamples, SampleType startDelay, SampleType endDelay)
+{
+	const auto numChannelsToRead = tapSignal.getNumChannels();
+
+	if (modDepthSamples <= 0 && startDelay == endDelay)
+	{
+		// a steady tap is a straight copy out of the ring, in at most two runs
+		const auto delay = std::max (1, juce::roundToInt (startDelay));
+
+		for (auto done = 0; done < numSamples;)
+		{
+			const auto readPos = (writePos + done - delay) & ringMask;
+			const auto run	   = std::min (numSamples - done, ringSize - readPos);
+
+			for (auto chan = 0; chan < numChannelsToRead; ++chan)
+				juce::FloatVectorOperations::copy (tapSignal.getWritePointer (chan, done), ring.data() + chan * ringSize + readPos, run);
+
+			done += run;
+		}
+
+		return;
+	}
+
+	const auto* lfo	 = (tap % 2 == 0) ? lfoSin.data() : lfoCos.data();
+	const auto	sign = (tap % 4 < 2) ? SampleType (1) : SampleType (-1);
+
+	const auto delayStep = (endDelay - startDelay) / static_cast<SampleType> (numSamples);
+
+	for (auto i = 0; i < numSamples; ++i)
 	{
-		delay.setDryWet (parameters.delayDryWet->get());
+		auto delay = startDelay + delayStep * static_cast<SampleType> (i);
+
+		if (modDepthSamples > 0)
+			delay += modDepthSamples * SampleType (0.5) * (SampleType (1) + sign * lfo[i]);
 
-		delay.process (audio);
-		meters.delayLevel->set (static_cast<float> (delay.getAverageGainReduction()));
+		const auto readPos	 = static_cast<SampleType> (writePos + i) - delay;
+		const auto whole	 = static_cast<int> (std::floor (readPos));
+		const auto t		 = readPos - static_cast<SampleType> (whole);
+		const auto baseIndex = whole - 1;
+
+		for (auto chan = 0; chan < numChannelsToRead; ++chan)
+		{
+			const auto* line = ring.data() + chan * ringSize;
+
+			const auto y0 = line[baseIndex & ringMask];
+			const auto y1 = line[(baseIndex + 1) & ringMask];
+			const auto y2 = line[(baseIndex + 2) & ringMask];
+			const auto y3 = line[(baseIndex + 3) & ringMask];
+
+			// 4-point, 3rd-order Hermite
+			const auto c1 = SampleType (0.5) * (y2 - y0);
+			const auto c2 = y0 - SampleType (2.5) * y1 + SampleType (2) * y2 - SampleType (0.5) * y3;
+			const auto c3 = SampleType (0.5) * (y3 - y0) + SampleType (1.5) * (y1 - y2);
+
+			tapSignal.setSample (chan, i, ((c3 * t + c2) * t + c1) * t + y1);
+		}
 	}
-	else
+}
+
+template <typename SampleType>
+void Delay<SampleType>::write (const SampleType* const* input, int numChannelsToUse, int numSamples)
+{
+	for (auto done = 0; done < numSamples;)
 	{
-		meters.delayLevel->set (-60.f);
+		const auto pos = (writePos + done) & ringMask;
+		const auto run = std::min (numSamples - done, ringSize - pos);
+
+		for (auto chan = 0; chan < numChannelsToUse; ++chan)
+			juce::FloatVectorOperations::copy (ring.data() + chan * ringSize + pos, input[chan] + done, run);
+
+		// a mono input still keeps both channels of the line in step
+		for (auto chan = numChannelsToUse; chan < numChannels; ++chan)
+			juce::FloatVectorOperations::copy (ring.data() + chan * ringSize + pos, input[0] + done, run);
+
+		done += run;
 	}
+
+	writePos = (writePos + numSamples) & ringMask;
 }
 
 template <typename SampleType>
-void Delay<SampleType>::prepare (double samplerate, int blocksize)
+SampleType Delay<SampleType>::getMaxChunkSize() const noexcept
 {
-	delay.prepare (samplerate, blocksize);
+	// the interpolator reads up to two samples past the read position
+	const auto shortestTap = std::min (currentDelay, targetDelay) / static_cast<SampleType> (numTaps);
+
+	return juce::jlimit (SampleType (1), static_cast<SampleType> (blocksize), std::floor (shortestTap) - SampleType (3));
+}
+
+template <typename SampleType>
+void Delay<SampleType>::updateSettings()
+{
+	mix		 = static_cast<SampleType> (parameters.delayDryWet->get()) * SampleType (0.01);
+	feedback = static_cast<SampleType> (std::min (maxFeedback, parameters.delayFeedback->get() * 0.01));
+	numTaps	 = juce::jlimit (1, maxTaps, parameters.delayTaps->get());
+
+	modDepthSamples = static_cast<SampleType> (parameters.delayModDepth->get() * 0.01 * maxModSeconds * samplerate);
+	lfoIncrement	= static_cast<SampleType> (juce::MathConstants<double>::twoPi * parameters.delayModRate->get() / samplerate);
+
+	for (auto tap = 0; tap < maxTaps; ++tap)
+	{
+		// the earlier taps are a little quieter than the full-length one, and alternate sides
+		tapGains[static_cast<size_t> (tap)] = static_cast<SampleType> (std::pow (0.7, numTaps - 1 - tap));
+		tapPans[static_cast<size_t> (tap)]	= numTaps == 1 ? SampleType (0) : (tap % 2 == 0 ? SampleType (-0.6) : SampleType (0.6));
+	}
+}
+
+template <typename SampleType>
+void Delay<SampleType>::updateDelayTime()
+{
+	auto seconds = static_cast<double> (parameters.delayTime->get());
+
+	if (parameters.delaySync->get())
+		seconds = 60. / state.tempo.load (std::memory_order_relaxed) * DelayState::getDivisionInBeats (parameters.delayDivision->get());
+
+	seconds = juce::jlimit (minDelaySeconds, maxDelaySeconds - maxModSeconds, seconds);
+
+	targetDelay = static_cast<SampleType> (seconds * samplerate);
+}
+
+template <typename SampleType>
+void Delay<SampleType>::prepare (double newSamplerate, int newBlocksize)
+{
+	samplerate = newSamplerate;
+	blocksize  = newBlocksize;
+
+	ringSize = juce::nextPowerOfTwo (static_cast<int> (std::ceil (maxDelaySeconds * samplerate)) + 4);
+	ringMask = ringSize - 1;
+
+	ring.assign (static_cast<size_t> (numChannels * ringSize), SampleType (0));
+
+	wet.setSize (numChannels, blocksize);
+	tapSignal.setSize (numChannels, blocksize);
+
+	lfoSin.assign (static_cast<size_t> (blocksize), SampleType (0));
+	lfoCos.assign (static_cast<size_t> (blocksize), SampleType (0));
+
+	glideCoef = static_cast<SampleType> (std::exp (-1. / (glideSeconds * samplerate)));
+
+	lastVersion = 0;
+	updateSettings();
+	updateDelayTime();
+
+	reset();
+}
+
+template <typename SampleType>
+void Delay<SampleType>::reset()
+{
+	std::fill (ring.begin(), ring.end(), SampleType (0));
+
+	writePos	 = 0;
+	lfoPhase	 = 0;
+	currentDelay = targetDelay;
 }
 
-template struct Delay<float>;
-template struct Delay<double>;
+template class Delay<float>;
+template class Delay<double>;
 
 }  // namespace Imogen
@@ -2,24 +2,75 @@
 
 namespace Imogen
 {
+/* A multi-tap delay on one contiguous power-of-two ring buffer. The taps divide the delay time
+   evenly and are panned alternately left and right; the longest tap feeds back into the line.
+   The delay time can follow the host's tempo, and each tap can be modulated by its own phase
+   of a shared LFO.
+
+   Unmodulated taps at a steady delay time are read as block copies; taps that are modulated or
+   gliding to a new time are read sample by sample with cubic interpolation.
+ */
 template <typename SampleType>
-struct Delay
+class Delay
 {
+public:
+
 	using AudioBuffer = juce::AudioBuffer<SampleType>;
 
+	static constexpr auto maxTaps		  = 4;
+	static constexpr auto maxDelaySeconds = 4.;
+
 	Delay (State& stateToUse);
 
 	void process (AudioBuffer& audio);
 
 	void prepare (double samplerate, int blocksize);
 
+	void reset();
+
 private:
 
+	static constexpr auto numChannels = 2;
+
+	void updateSettings();
+	void updateDelayTime();
+
+	void processChunk (SampleType* const* channels, int numChannelsToUse, int start, int numSamples);
+
+	void readTap (int tap, int numSamples, SampleType startDelay, SampleType endDelay);
+	void write (const SampleType* const* input, int numChannelsToUse, int numSamples);
+
+	SampleType getMaxChunkSize() const noexcept;
+
 	State&		state;
-	Parameters& parameters { state.parameters };
-	Meters&		meters { state.meters };
+	DelayState& parameters { state.parameters.delayState };
+	Telemetry&	telemetry { state.telemetry };
+
+	double samplerate { 0. };
+	int	   blocksize { 0 };
+
+	// channel c of the ring starts at c * ringSize
+	std::vector<SampleType> ring;
+	int						ringSize { 0 }, ringMask { 0 };
+	int						writePos { 0 };
+
+	AudioBuffer wet, tapSignal;
+
+	std::vector<SampleType> lfoSin, lfoCos;
+
+	int		   numTaps { 1 };
+	SampleType mix { 0 }, feedback { 0 }, modDepthSamples { 0 };
+	SampleType targetDelay { 0 }, currentDelay { 0 }, glideCoef { 0 };
+	SampleType lfoPhase { 0 }, lfoIncrement { 0 };
+
+	std::array<SampleType, maxTaps> tapGains, tapPans;
+
+	juce::uint32 lastVersion { 0 };
 
-	dsp::FX::Delay<SampleType> delay;
+	static constexpr auto minDelaySeconds = 0.01;
+	static constexpr auto maxModSeconds	  = 0.005;
+	static constexpr auto glideSeconds	  = 0.05;
+	static constexpr auto maxFeedback	  = 0.95;
 };
 
 }  // namespace Imogen
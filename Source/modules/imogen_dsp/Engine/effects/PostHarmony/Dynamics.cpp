@@ -0,0 +1,193 @@
+
+namespace Imogen
+{
+template <typename SampleType>
+Dynamics<SampleType>::Dynamics (State& stateToUse)
+	: state (stateToUse)
+{
+	thresholds.fill (SampleType (1));
+	slopes.fill (SampleType (0));
+}
+
+template <typename SampleType>
+void Dynamics<SampleType>::prepare (double samplerate, int)
+{
+	const auto hp = BiquadCascade<SampleType>::Coefficients::makeHighPass (samplerate, sidechainHz, 0.707f);
+
+	const auto perLane = [] (double comp, double deEss)
+	{
+		return Lanes::set (static_cast<SampleType> (comp), static_cast<SampleType> (deEss),
+						   static_cast<SampleType> (comp), static_cast<SampleType> (deEss));
+	};
+
+	b0 = perLane (1., hp.b0);
+	b1 = perLane (0., hp.b1);
+	b2 = perLane (0., hp.b2);
+	a1 = perLane (0., hp.a1);
+	a2 = perLane (0., hp.a2);
+
+	const auto coefFor = [samplerate] (double ms)
+	{ return std::exp (-1000. / (ms * samplerate)); };
+
+	attackCoef	= perLane (coefFor (compAttackMs), coefFor (deEssAttackMs));
+	releaseCoef = perLane (coefFor (compReleaseMs), coefFor (deEssReleaseMs));
+
+	reset();
+
+	lastCompVersion	   = 0;
+	lastDeEsserVersion = 0;
+}
+
+template <typename SampleType>
+void Dynamics<SampleType>::reset()
+{
+	const auto zero = Lanes::broadcast (SampleType (0));
+
+	z1		 = zero;
+	z2		 = zero;
+	peak	 = zero;
+	envelope = zero;
+
+	dryGain = SampleType (1);
+	wetGain = SampleType (1);
+}
+
+template <typename SampleType>
+void Dynamics<SampleType>::updateSettings (bool compIsOn, bool deEsserIsOn)
+{
+	const auto amount = static_cast<float> (parameters.compAmount->get()) * 0.01f;
+
+	const auto compThresh = juce::Decibels::decibelsToGain (juce::jmap (amount, 0.f, -60.f));
+	const auto compSlope  = compIsOn ? 1.f - 1.f / juce::jmap (amount, 1.f, 10.f) : 0.f;
+
+	// at 100%, sibilance is held at the threshold
+	const auto deEssThresh = juce::Decibels::decibelsToGain (parameters.deEsserThresh->get());
+	const auto deEssSlope  = deEsserIsOn ? static_cast<float> (parameters.deEsserAmount->get()) * 0.01f : 0.f;
+
+	thresholds = { static_cast<SampleType> (compThresh), static_cast<SampleType> (deEssThresh),
+				   static_cast<SampleType> (compThresh), static_cast<SampleType> (deEssThresh) };
+
+	slopes = { static_cast<SampleType> (compSlope), static_cast<SampleType> (deEssSlope),
+			   static_cast<SampleType> (compSlope), static_cast<SampleType> (deEssSlope) };
+}
+
+template <typename SampleType>
+void Dynamics<SampleType>::process (AudioBuffer& dry, AudioBuffer& wet)
+{
+	const auto compIsOn	   = parameters.compToggle->get();
+	const auto deEsserIsOn = parameters.deEsserToggle->get();
+
+	const auto compChanged	  = parameters.compChanges.checkForChanges (lastCompVersion);
+	const auto deEsserChanged = parameters.deEsserChanges.checkForChanges (lastDeEsserVersion);
+
+	if (! compIsOn && ! deEsserIsOn)
+	{
+		if (compChanged || deEsserChanged)
+			reset();
+
+		return;
+	}
+
+	if (compChanged || deEsserChanged)
+		updateSettings (compIsOn, deEsserIsOn);
+
+	jassert (dry.getNumChannels() == 2 && wet.getNumChannels() == 2);
+	jassert (dry.getNumSamples() == wet.getNumSamples());
+
+	SampleType* channels[] = { dry.getWritePointer (0), dry.getWritePointer (1), wet.getWritePointer (0), wet.getWritePointer (1) };
+
+	totalReductionDb.fill (0.);
+	numChunks = 0;
+
+	const auto numSamples = dry.getNumSamples();
+
+	for (auto start = 0; start < numSamples; start += chunkSize)
+		processChunk (channels, start, std::min (chunkSize, numSamples - start));
+
+	const auto averageOf = [this] (Detector a, Detector b)
+	{ return static_cast<float> ((totalReductionDb[a] + totalReductionDb[b]) * 0.5 / std::max (1, numChunks)); };
+
+	if (compIsOn)
+		telemetry.reportGainReduction (TelemetryRecord::compressor, averageOf (dryComp, wetComp));
+
+	if (deEsserIsOn)
+		telemetry.reportGainReduction (TelemetryRecord::deEsser, averageOf (dryDeEss, wetDeEss));
+}
+
+template <typename SampleType>
+void Dynamics<SampleType>::processChunk (SampleType* const* channels, int start, int numSamples) noexcept
+{
+	const auto one	= Lanes::broadcast (SampleType (1));
+	const auto half = SampleType (0.5);
+
+	const auto attackGain  = one - attackCoef;
+	const auto releaseGain = one - releaseCoef;
+
+	const auto end = start + numSamples;
+
+	// detect
+	for (auto i = start; i < end; ++i)
+	{
+		const auto dryL = channels[0][i], dryR = channels[1][i];
+		const auto wetL = channels[2][i], wetR = channels[3][i];
+
+		const auto x = Lanes::set (std::max (std::abs (dryL), std::abs (dryR)), (dryL + dryR) * half,
+								   std::max (std::abs (wetL), std::abs (wetR)), (wetL + wetR) * half);
+
+		const auto y = b0 * x + z1;
+
+		z1 = b1 * x - a1 * y + z2;
+		z2 = b2 * x - a2 * y;
+
+		const auto level = abs (y);
+
+		peak	 = max (level, releaseCoef * peak + releaseGain * level);
+		envelope = attackCoef * envelope + attackGain * peak;
+	}
+
+	// compute the gains at the end of the chunk
+	std::array<SampleType, numDetectors> levels;
+	envelope.store (levels.data());
+
+	std::array<SampleType, numDetectors> gains;
+
+	for (size_t d = 0; d < numDetectors; ++d)
+	{
+		gains[d] = SampleType (1);
+
+		if (slopes[d] > SampleType (0) && levels[d] > thresholds[d])
+		{
+			const auto reductionDb = -slopes[d] * juce::Decibels::gainToDecibels (levels[d] / thresholds[d]);
+
+			gains[d] = juce::Decibels::decibelsToGain (reductionDb);
+			totalReductionDb[d] += static_cast<double> (reductionDb);
+		}
+	}
+
+	++numChunks;
+
+	// apply both gains, ramping from where the last chunk left off
+	const auto newDryGain = gains[dryComp] * gains[dryDeEss];
+	const auto newWetGain = gains[wetComp] * gains[wetDeEss];
+
+	const auto step = SampleType (1) / static_cast<SampleType> (numSamples);
+
+	const auto increment = Lanes::set ((newDryGain - dryGain) * step, (newDryGain - dryGain) * step,
+									   (newWetGain - wetGain) * step, (newWetGain - wetGain) * step);
+
+	auto gain = Lanes::set (dryGain, dryGain, wetGain, wetGain);
+
+	for (auto i = start; i < end; ++i)
+	{
+		gain = gain + increment;
+		(Lanes::gather (channels, i) * gain).scatter (channels, i);
+	}
+
+	dryGain = newDryGain;
+	wetGain = newWetGain;
+}
+
+template class Dynamics<float>;
+template class Dynamics<double>;
+
+}  // namespace Imogen
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <imogen_dsp/Engine/SIMD.h>
+
+namespace Imogen
+{
+/* The compressor and de-esser for both the dry and wet signals, in one pass over each buffer.
+   Each signal gets a stereo-linked compressor detector and a de-esser detector that listens
+   to a high-passed sidechain; all four detectors run side by side in SIMD lanes. The gain is
+   computed every few samples and ramped between, and both gains are applied in the same loop.
+ */
+template <typename SampleType>
+class Dynamics
+{
+public:
+
+	using AudioBuffer = juce::AudioBuffer<SampleType>;
+
+	Dynamics (State& stateToUse);
+
+	void process (AudioBuffer& dry, AudioBuffer& wet);
+
+	void prepare (double samplerate, int blocksize);
+
+private:
+
+	using Lanes = Lanes4<SampleType>;
+
+	enum Detector
+	{
+		dryComp,
+		dryDeEss,
+		wetComp,
+		wetDeEss,
+		numDetectors
+	};
+
+	void updateSettings (bool compIsOn, bool deEsserIsOn);
+
+	void processChunk (SampleType* const* channels, int start, int numSamples) noexcept;
+
+	void reset();
+
+	State&		state;
+	Parameters& parameters { state.parameters };
+	Telemetry&	telemetry { state.telemetry };
+
+	// sidechain filters, which pass the compressor lanes through unchanged
+	Lanes b0, b1, b2, a1, a2, z1, z2;
+
+	// a smooth branching peak detector per lane: instant attack and exponential release, then smoothed by the attack time
+	Lanes attackCoef, releaseCoef, peak, envelope;
+
+	std::array<SampleType, numDetectors> thresholds, slopes;
+
+	SampleType dryGain { 1 }, wetGain { 1 };
+
+	std::array<double, numDetectors> totalReductionDb;
+	int								 numChunks { 0 };
+
+	juce::uint32 lastCompVersion { 0 }, lastDeEsserVersion { 0 };
+
+	static constexpr auto chunkSize = 16;
+
+	static constexpr auto compAttackMs	 = 4.;
+	static constexpr auto compReleaseMs	 = 200.;
+	static constexpr auto deEssAttackMs	 = 0.5;
+	static constexpr auto deEssReleaseMs = 60.;
+	static constexpr auto sidechainHz	 = 5000.f;
+};
+
+}  // namespace Imogen
@@ -5,15 +5,6 @@ template <typename SampleType>
 EQ<SampleType>::EQ (EQState& params)
 	: parameters (params)
 {
-	dryEQ.addBand (FT::LowShelf, 80.f);
-	dryEQ.addBand (FT::HighShelf, 10000.f);
-	dryEQ.addBand (FT::HighPass, 80.f);
-	dryEQ.addBand (FT::Peak, 2500.f);
-
-	wetEQ.addBand (FT::LowShelf, 80.f);
-	wetEQ.addBand (FT::HighShelf, 10000.f);
-	wetEQ.addBand (FT::HighPass, 80.f);
-	wetEQ.addBand (FT::Peak, 2500.f);
 }
 
 template <typename SampleType>
@@ -22,90 +13,78 @@ void EQ<SampleType>::process (AudioBuffer& dry, AudioBuffer& wet)
 	if (! parameters.eqToggle->get())
 		return;
 
-	updateLowShelf (parameters.eqLowShelfFreq->get(), parameters.eqLowShelfQ->get(), parameters.eqLowShelfGain->get());
-	updateHighShelf (parameters.eqHighShelfFreq->get(), parameters.eqHighShelfQ->get(), parameters.eqHighShelfGain->get());
-	updatePeak (parameters.eqPeakFreq->get(), parameters.eqPeakQ->get(), parameters.eqPeakGain->get());
-	updateHighPass (parameters.eqHighPassFreq->get(), parameters.eqHighPassQ->get());
+	if (parameters.changes.checkForChanges (lastVersion))
+		updateCoefficients();
 
-	dryEQ.process (dry);
-	wetEQ.process (wet);
+	jassert (dry.getNumChannels() == 2 && wet.getNumChannels() == 2);
+	jassert (dry.getNumSamples() == wet.getNumSamples());
+
+	const std::array<SampleType*, 4> channels { dry.getWritePointer (0), dry.getWritePointer (1), wet.getWritePointer (0), wet.getWritePointer (1) };
+
+	if (isPrecise[lowShelf] || isPrecise[highPass])
+		preciseBands.process (channels, dry.getNumSamples());
+
+	bands.process (channels, dry.getNumSamples());
 }
 
 template <typename SampleType>
-void EQ<SampleType>::updateLowShelf (float freq, float Q, float gain)
+void EQ<SampleType>::updateCoefficients()
 {
-	if (auto* dry = dryEQ.getBandOfType (FT::LowShelf))
-	{
-		dry->setFilterFrequency (freq);
-		dry->setQfactor (Q);
-		dry->setGain (gain);
-	}
+	const auto lowShelfFreq = parameters.eqLowShelfFreq->get();
+	const auto highPassFreq = parameters.eqHighPassFreq->get();
 
-	if (auto* wet = wetEQ.getBandOfType (FT::LowShelf))
-	{
-		wet->setFilterFrequency (freq);
-		wet->setQfactor (Q);
-		wet->setGain (gain);
-	}
+	setLowBand (lowShelf, lowShelfFreq, PreciseCoefficients::makeLowShelf (samplerate, lowShelfFreq, parameters.eqLowShelfQ->get(), parameters.eqLowShelfGain->get()));
+	setLowBand (highPass, highPassFreq, PreciseCoefficients::makeHighPass (samplerate, highPassFreq, parameters.eqHighPassQ->get()));
+
+	bands.setCoefficients (highShelf, Coefficients::makeHighShelf (samplerate, parameters.eqHighShelfFreq->get(), parameters.eqHighShelfQ->get(), parameters.eqHighShelfGain->get()));
+	bands.setCoefficients (peak, Coefficients::makePeak (samplerate, parameters.eqPeakFreq->get(), parameters.eqPeakQ->get(), parameters.eqPeakGain->get()));
 }
 
 template <typename SampleType>
-void EQ<SampleType>::updateHighShelf (float freq, float Q, float gain)
+void EQ<SampleType>::setLowBand (Band band, float freq, const PreciseCoefficients& coefs) noexcept
 {
-	if (auto* dry = dryEQ.getBandOfType (FT::HighShelf))
-	{
-		dry->setFilterFrequency (freq);
-		dry->setQfactor (Q);
-		dry->setGain (gain);
-	}
+	const auto precise = needsHighPrecision (freq);
 
-	if (auto* wet = wetEQ.getBandOfType (FT::HighShelf))
+	// the band starts again from silence in the cascade it moves to, and its old stage mustn't keep ringing
+	if (precise != isPrecise[band])
 	{
-		wet->setFilterFrequency (freq);
-		wet->setQfactor (Q);
-		wet->setGain (gain);
+		preciseBands.reset (band);
+		bands.reset (band);
+
+		isPrecise[band] = precise;
 	}
-}
 
-template <typename SampleType>
-void EQ<SampleType>::updatePeak (float freq, float Q, float gain)
-{
-	if (auto* dry = dryEQ.getBandOfType (FT::Peak))
+	if (precise)
 	{
-		dry->setFilterFrequency (freq);
-		dry->setQfactor (Q);
-		dry->setGain (gain);
+		preciseBands.setCoefficients (band, coefs);
+		bands.setCoefficients (band, {});
 	}
-
-	if (auto* wet = wetEQ.getBandOfType (FT::Peak))
+	else
 	{
-		wet->setFilterFrequency (freq);
-		wet->setQfactor (Q);
-		wet->setGain (gain);
+		preciseBands.setCoefficients (band, {});
+		bands.setCoefficients (band, { coefs.b0, coefs.b1, coefs.b2, coefs.a1, coefs.a2 });
 	}
 }
 
 template <typename SampleType>
-void EQ<SampleType>::updateHighPass (float freq, float Q)
+bool EQ<SampleType>::needsHighPrecision (float freq) const noexcept
 {
-	if (auto* dry = dryEQ.getBandOfType (FT::HighPass))
-	{
-		dry->setFilterFrequency (freq);
-		dry->setQfactor (Q);
-	}
-
-	if (auto* wet = wetEQ.getBandOfType (FT::HighPass))
-	{
-		wet->setFilterFrequency (freq);
-		wet->setQfactor (Q);
-	}
+	// a double engine running in double throughout gains nothing from the second cascade
+	if constexpr (std::is_same_v<SampleType, HighPrecision>)
+		return false;
+	else
+		return static_cast<double> (freq) < samplerate * preciseBelow;
 }
 
 template <typename SampleType>
-void EQ<SampleType>::prepare (double samplerate, int blocksize)
+void EQ<SampleType>::prepare (double newSamplerate, int)
 {
-	dryEQ.prepare (samplerate, blocksize);
-	wetEQ.prepare (samplerate, blocksize);
+	samplerate = newSamplerate;
+
+	preciseBands.reset();
+	bands.reset();
+
+	lastVersion = 0;
 }
 
 template struct EQ<float>;
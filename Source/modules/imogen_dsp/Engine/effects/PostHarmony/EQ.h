@@ -1,6 +1,10 @@
 
 #pragma once
 
+#include <imogen_dsp/Engine/Precision.h>
+
+#include "BiquadCascade.h"
+
 namespace Imogen
 {
 template <typename SampleType>
@@ -16,16 +20,43 @@ struct EQ
 
 private:
 
-	using FT = dsp::FX::FilterType;
+	using PreciseCoefficients = typename BiquadCascade<HighPrecision>::Coefficients;
+	using Coefficients		  = typename BiquadCascade<SampleType>::Coefficients;
+
+	// the low bands come first, so that they have the same stage in both cascades
+	enum Band
+	{
+		lowShelf,
+		highPass,
+		highShelf,
+		peak,
+		numBands
+	};
+
+	static constexpr auto numLowBands = 2;
+
+	void updateCoefficients();
 
-	void updateLowShelf (float freq, float Q, float gain);
-	void updateHighShelf (float freq, float Q, float gain);
-	void updatePeak (float freq, float Q, float gain);
-	void updateHighPass (float freq, float Q);
+	/* Puts a low band in whichever cascade its cutoff needs, leaving its stage in the other one passing audio through. */
+	void setLowBand (Band band, float freq, const PreciseCoefficients& coefs) noexcept;
+
+	bool needsHighPrecision (float freq) const noexcept;
 
 	EQState& parameters;
 
-	dsp::FX::EQ<SampleType> dryEQ, wetEQ;
+	// The dry and wet signals share one set of bands, so all four channels run through them together.
+	// A low band whose cutoff is a small enough fraction of the samplerate has its poles so close to
+	// the unit circle that float rounding makes it noisy, so only then is it run in double.
+	BiquadCascade<HighPrecision> preciseBands { numLowBands };
+	BiquadCascade<SampleType>	 bands { numBands };
+
+	std::array<bool, numLowBands> isPrecise { false, false };
+
+	static constexpr auto preciseBelow = 0.01;
+
+	double samplerate { 44100. };
+
+	juce::uint32 lastVersion { 0 };
 };
 
 }  // namespace Imogen
@@ -4,35 +4,285 @@ namespace Imogen
 template <typename SampleType>
 Limiter<SampleType>::Limiter (State& stateToUse) : state (stateToUse)
 {
-	//    static constexpr auto limiterThreshDb     = 0.0f;
-	//    static constexpr auto limiterReleaseMs    = 35.0f;
+	// a windowed-sinc interpolation filter, split into its polyphase components
+	constexpr auto length = oversampling * tapsPerPhase;
+	constexpr auto centre = (length - 1) * 0.5;
+
+	std::array<std::array<SampleType, oversampling>, tapsPerPhase> coefs;
+
+	for (auto n = 0; n < length; ++n)
+	{
+		const auto x	  = (n - centre) / oversampling;
+		const auto sinc	  = x == 0. ? 1. : std::sin (juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+		const auto phase  = juce::MathConstants<double>::twoPi * n / (length - 1);
+		const auto window = 0.42 - 0.5 * std::cos (phase) + 0.08 * std::cos (2. * phase);
+
+		coefs[static_cast<size_t> (n / oversampling)][static_cast<size_t> (n % oversampling)] = static_cast<SampleType> (sinc * window);
+	}
+
+	// normalise each phase to unity gain at DC
+	for (auto p = 0; p < oversampling; ++p)
+	{
+		auto sum = SampleType (0);
+
+		for (const auto& tap : coefs)
+			sum += tap[static_cast<size_t> (p)];
+
+		for (auto& tap : coefs)
+			tap[static_cast<size_t> (p)] /= sum;
+	}
+
+	for (auto k = 0; k < tapsPerPhase; ++k)
+	{
+		const auto& c = coefs[static_cast<size_t> (k)];
+
+		phaseCoefs[static_cast<size_t> (k)] = Lanes::set (c[0], c[1], c[2], c[3]);
+	}
 }
 
 template <typename SampleType>
 void Limiter<SampleType>::process (AudioBuffer& audio)
 {
-	if (parameters.limiterToggle->get())
+	if (parameters.limiterChanges.checkForChanges (lastVersion))
+		updateSettings();
+
+	const auto numSamples		= audio.getNumSamples();
+	const auto numChannelsToUse = std::min (numChannels, audio.getNumChannels());
+
+	jassert (numSamples <= static_cast<int> (gains.size()));
+
+	if (isOn)
 	{
-		limiter.process (audio);
-		meters.limRedux->set (static_cast<float> (limiter.getAverageGainReduction()));
+		auto totalGain = 0.;
+
+		for (auto i = 0; i < numSamples; ++i)
+		{
+			Frame frame {};
+
+			for (auto chan = 0; chan < numChannelsToUse; ++chan)
+				frame[static_cast<size_t> (chan)] = audio.getSample (chan, i);
+
+			const auto gain = measure (frame, numChannelsToUse);
+
+			gains[static_cast<size_t> (i)] = gain;
+			totalGain += static_cast<double> (gain);
+		}
+
+		delayAudio (audio, numChannelsToUse);
+
+		for (auto chan = 0; chan < numChannelsToUse; ++chan)
+			juce::FloatVectorOperations::multiply (audio.getWritePointer (chan), gains.data(), numSamples);
+
+		const auto averageGain = totalGain / std::max (1, numSamples);
+
+		telemetry.reportGainReduction (TelemetryRecord::limiter, -juce::Decibels::gainToDecibels (static_cast<float> (averageGain)));
 	}
 	else
 	{
-		meters.limRedux->set (0.f);
+		delayAudio (audio, numChannelsToUse);
+	}
+}
+
+template <typename SampleType>
+SampleType Limiter<SampleType>::measure (const Frame& frame, int numChannelsToUse) noexcept
+{
+	// each sample is written twice, so that the newest tapsPerPhase are always contiguous
+	historyPos = (historyPos + tapsPerPhase - 1) % tapsPerPhase;
+
+	for (auto chan = 0; chan < numChannelsToUse; ++chan)
+	{
+		auto& history = recentInput[static_cast<size_t> (chan)];
+
+		history[static_cast<size_t> (historyPos)] = history[static_cast<size_t> (historyPos + tapsPerPhase)] = frame[static_cast<size_t> (chan)];
+	}
+
+	const auto peak = getTruePeak (numChannelsToUse);
+
+	return pushGain (peak > ceiling ? ceiling / peak : SampleType (1));
+}
+
+template <typename SampleType>
+SampleType Limiter<SampleType>::getTruePeak (int numChannelsToUse) const noexcept
+{
+	auto peaks = Lanes::broadcast (SampleType (0));
+
+	for (auto chan = 0; chan < numChannelsToUse; ++chan)
+	{
+		// newest sample first, so tap k meets the input from k samples ago
+		const auto* x = recentInput[static_cast<size_t> (chan)].data() + historyPos;
+
+		auto acc = Lanes::broadcast (SampleType (0));
+
+		for (auto k = 0; k < tapsPerPhase; ++k)
+			acc = acc + phaseCoefs[static_cast<size_t> (k)] * Lanes::broadcast (x[k]);
+
+		// the interpolated points sit between samples 6 and 5 back, so the sample 6 back closes the span
+		peaks = max (peaks, max (abs (acc), abs (Lanes::broadcast (x[tapsPerPhase / 2]))));
+	}
+
+	std::array<SampleType, oversampling> values;
+	peaks.store (values.data());
+
+	return *std::max_element (values.begin(), values.end());
+}
+
+template <typename SampleType>
+SampleType Limiter<SampleType>::pushGain (SampleType requiredGain) noexcept
+{
+	// the minimum over the window: older entries that are no lower than the new one can never be the minimum again
+	while (minQueueBack != minQueueFront && minQueue[static_cast<size_t> ((minQueueBack - 1) & minQueueMask)].second >= requiredGain)
+		--minQueueBack;
+
+	minQueue[static_cast<size_t> (minQueueBack++ & minQueueMask)] = { position, requiredGain };
+
+	if (minQueue[static_cast<size_t> (minQueueFront & minQueueMask)].first <= position - holdWindow)
+		++minQueueFront;
+
+	++position;
+
+	const auto held = minQueue[static_cast<size_t> (minQueueFront & minQueueMask)].second;
+
+	envelope = held < envelope ? held : held + releaseCoef * (envelope - held);
+
+	// a moving average over the window turns each step down into a ramp that lands on the peak
+	heldGainsSum += static_cast<double> (envelope - heldGains[static_cast<size_t> (heldGainsPos)]);
+	heldGains[static_cast<size_t> (heldGainsPos)] = envelope;
+
+	if (++heldGainsPos == averageWindow)
+	{
+		heldGainsPos = 0;
+		heldGainsSum = std::accumulate (heldGains.begin(), heldGains.end(), 0.);
 	}
 
+	return static_cast<SampleType> (heldGainsSum / averageWindow);
+}
+
+template <typename SampleType>
+void Limiter<SampleType>::delayAudio (AudioBuffer& audio, int numChannelsToUse)
+{
 	const auto numSamples = audio.getNumSamples();
-	meters.outputLevelL->set (static_cast<float> (audio.getRMSLevel (0, 0, numSamples)));
-	meters.outputLevelR->set (static_cast<float> (audio.getRMSLevel (1, 0, numSamples)));
+
+	// write the whole block in, then read it back out the lookahead earlier, each in at most two runs
+	for (auto chan = 0; chan < numChannelsToUse; ++chan)
+	{
+		auto* line	  = delayLine.data() + chan * delaySize;
+		auto* samples = audio.getWritePointer (chan);
+
+		for (auto done = 0; done < numSamples;)
+		{
+			const auto pos = (delayWritePos + done) & delayMask;
+			const auto run = std::min (numSamples - done, delaySize - pos);
+
+			juce::FloatVectorOperations::copy (line + pos, samples + done, run);
+			done += run;
+		}
+
+		for (auto done = 0; done < numSamples;)
+		{
+			const auto pos = (delayWritePos - lookahead + done) & delayMask;
+			const auto run = std::min (numSamples - done, delaySize - pos);
+
+			juce::FloatVectorOperations::copy (samples + done, line + pos, run);
+			done += run;
+		}
+	}
+
+	delayWritePos = (delayWritePos + numSamples) & delayMask;
+}
+
+template <typename SampleType>
+void Limiter<SampleType>::updateSettings()
+{
+	ceiling		= static_cast<SampleType> (juce::Decibels::decibelsToGain (parameters.limiterCeiling->get()));
+	releaseCoef = static_cast<SampleType> (std::exp (-1. / (std::max (0.001, static_cast<double> (parameters.limiterRelease->get())) * samplerate)));
+
+	// while it was off, the detector missed everything, so it would start from stale peaks
+	const auto wasOn = std::exchange (isOn, parameters.limiterToggle->get());
+
+	if (isOn && ! wasOn)
+		restartDetector();
+}
+
+/* The audio still goes through the delay line while the limiter is off, so the lookahead's worth
+   that comes out first once it's back on is measured here, the way it would have been on the way in.
+ */
+template <typename SampleType>
+void Limiter<SampleType>::restartDetector() noexcept
+{
+	resetDetector();
+
+	for (auto i = lookahead; i > 0; --i)
+	{
+		const auto pos = (delayWritePos - i) & delayMask;
+
+		Frame frame;
+
+		for (auto chan = 0; chan < numChannels; ++chan)
+			frame[static_cast<size_t> (chan)] = delayLine[static_cast<size_t> (chan * delaySize + pos)];
+
+		measure (frame, numChannels);
+	}
 }
 
 template <typename SampleType>
-void Limiter<SampleType>::prepare (double samplerate, int blocksize)
+void Limiter<SampleType>::prepare (double newSamplerate, int blocksize)
 {
-	limiter.prepare (samplerate, blocksize);
+	samplerate = newSamplerate;
+
+	lookahead = std::max (tapsPerPhase, juce::roundToInt (lookaheadSeconds * samplerate));
+
+	// A held gain covers the detector positions of its whole hold window, and the moving average
+	// then only guarantees the positions that every held gain in its window covers: with the hold
+	// one sample longer, those are the two positions that measured the spans either side of the
+	// delayed sample, which the detector reports half its length late.
+	averageWindow = lookahead - tapsPerPhase / 2 + 1;
+	holdWindow	  = averageWindow + 1;
+
+	minQueue.resize (static_cast<size_t> (juce::nextPowerOfTwo (holdWindow + 1)));
+	minQueueMask = static_cast<int> (minQueue.size()) - 1;
+
+	heldGains.resize (static_cast<size_t> (averageWindow));
+
+	delaySize = juce::nextPowerOfTwo (lookahead + blocksize);
+	delayMask = delaySize - 1;
+	delayLine.resize (static_cast<size_t> (numChannels * delaySize));
+
+	gains.resize (static_cast<size_t> (blocksize));
+
+	lastVersion = 0;
+	updateSettings();
+
+	reset();
+}
+
+template <typename SampleType>
+void Limiter<SampleType>::reset()
+{
+	resetDetector();
+
+	std::fill (delayLine.begin(), delayLine.end(), SampleType (0));
+	delayWritePos = 0;
+}
+
+template <typename SampleType>
+void Limiter<SampleType>::resetDetector() noexcept
+{
+	for (auto& history : recentInput)
+		history.fill (SampleType (0));
+
+	historyPos = 0;
+
+	minQueueFront = 0;
+	minQueueBack  = 0;
+	position	  = 0;
+
+	std::fill (heldGains.begin(), heldGains.end(), SampleType (1));
+	heldGainsPos = 0;
+	heldGainsSum = static_cast<double> (averageWindow);
+	envelope	 = SampleType (1);
 }
 
-template struct Limiter<float>;
-template struct Limiter<double>;
+template class Limiter<float>;
+template class Limiter<double>;
 
 }  // namespace Imogen
@@ -1,10 +1,23 @@
 #pragma once
 
+#include <imogen_dsp/Engine/SIMD.h>
+
 namespace Imogen
 {
+/* A lookahead limiter that holds true peaks below the ceiling.
+   Peaks are measured on a 4x polyphase upsampling of the signal, so that overs between samples
+   are caught too. The gain needed for each peak is held by a sliding-window minimum and then
+   smoothed by a moving average over about the same window, so the gain has reached its target
+   by the time the delayed peak comes out.
+
+   The audio is always delayed by the lookahead, even when the limiter is switched off, so that
+   the latency reported to the host never changes.
+ */
 template <typename SampleType>
-struct Limiter
+class Limiter
 {
+public:
+
 	using AudioBuffer = juce::AudioBuffer<SampleType>;
 
 	Limiter (State& stateToUse);
@@ -13,13 +26,72 @@ struct Limiter
 
 	void prepare (double samplerate, int blocksize);
 
+	void reset();
+
+	int getLatencySamples() const noexcept { return lookahead; }
+
 private:
 
+	static constexpr auto numChannels	   = 2;
+	static constexpr auto oversampling	   = 4;
+	static constexpr auto tapsPerPhase	   = 12;
+	static constexpr auto lookaheadSeconds = 0.0015;
+
+	using Lanes = Lanes4<SampleType>;
+
+	// one sample of every channel
+	using Frame = std::array<SampleType, numChannels>;
+
+	void updateSettings();
+
+	void resetDetector() noexcept;
+	void restartDetector() noexcept;
+
+	/* Feeds one sample of every channel to the detector, and returns the gain for the delayed output. */
+	SampleType measure (const Frame& frame, int numChannelsToUse) noexcept;
+
+	SampleType getTruePeak (int numChannelsToUse) const noexcept;
+
+	SampleType pushGain (SampleType requiredGain) noexcept;
+
+	void delayAudio (AudioBuffer& audio, int numChannelsToUse);
+
 	State&		state;
 	Parameters& parameters { state.parameters };
-	Meters&		meters { state.meters };
+	Telemetry&	telemetry { state.telemetry };
+
+	// the coefficients for tap k hold every phase's k-th coefficient, one per lane
+	std::array<Lanes, tapsPerPhase> phaseCoefs;
+
+	// the recent input of each channel, newest first from historyPos
+	std::array<std::array<SampleType, 2 * tapsPerPhase>, numChannels> recentInput;
+	int																  historyPos { 0 };
+
+	int lookahead { 0 }, averageWindow { 0 }, holdWindow { 0 };
+
+	// a monotonic queue of (position, gain) for the sliding-window minimum
+	std::vector<std::pair<juce::int64, SampleType>> minQueue;
+	int												minQueueMask { 0 }, minQueueFront { 0 }, minQueueBack { 0 };
+	juce::int64										position { 0 };
+
+	// the last window of held gains, for the moving average
+	std::vector<SampleType> heldGains;
+	int						heldGainsPos { 0 };
+	double					heldGainsSum { 0. };
+
+	SampleType envelope { 1 }, releaseCoef { 0 }, ceiling { 1 };
+
+	std::vector<SampleType> delayLine;
+	int						delaySize { 0 }, delayMask { 0 }, delayWritePos { 0 };
+
+	std::vector<SampleType> gains;
+
+	double samplerate { 0. };
+
+	// only changes with the limiter's parameter group, so that switching on always restarts the detector
+	bool isOn { false };
 
-	dsp::FX::Limiter<SampleType> limiter;
+	juce::uint32 lastVersion { 0 };
 };
 
 }  // namespace Imogen
@@ -11,35 +11,140 @@ void Reverb<SampleType>::process (AudioBuffer& audio)
 {
 	if (parameters.reverbToggle->get())
 	{
-		reverb.setDryWet (parameters.reverbDryWet->get());
-		reverb.setDuckAmount (parameters.reverbDuck->get());
-		reverb.setLoCutFrequency (parameters.reverbLoCut->get());
-		reverb.setHiCutFrequency (parameters.reverbHiCut->get());
+		if (parameters.changes.checkForChanges (lastVersion))
+			updateSettings();
 
-		const auto d = static_cast<float> (parameters.reverbDecay->get()) * 0.01f;
-		reverb.setDamping (1.f - d);
-		reverb.setRoomSize (d);
+		const auto useConvolution = parameters.reverbConvolution->get();
+
+		if (useConvolution)
+			convolution.update();
+
+		if (useConvolution && convolution.isReady())
+		{
+			processConvolution (audio);
+			return;
+		}
 
 		SampleType level;
 		reverb.process (audio, &level);
-		meters.reverbLevel->set (static_cast<float> (level));
+		telemetry.reportEffectLevel (TelemetryRecord::reverb, static_cast<float> (level));
+	}
+}
+
+template <typename SampleType>
+void Reverb<SampleType>::updateSettings()
+{
+	reverb.setDryWet (parameters.reverbDryWet->get());
+	reverb.setDuckAmount (parameters.reverbDuck->get());
+	reverb.setLoCutFrequency (parameters.reverbLoCut->get());
+	reverb.setHiCutFrequency (parameters.reverbHiCut->get());
+
+	const auto d = static_cast<float> (parameters.reverbDecay->get()) * 0.01f;
+	reverb.setDamping (1.f - d);
+	reverb.setRoomSize (d);
+
+	mix	 = static_cast<float> (parameters.reverbDryWet->get()) * 0.01f;
+	duck = static_cast<float> (parameters.reverbDuck->get()) * 0.01f;
+
+	using Coefs = BiquadCascade<float>::Coefficients;
+
+	constexpr auto butterworthQ = 0.7071f;
+
+	filters.setCoefficients (loCut, Coefs::makeHighPass (samplerate, parameters.reverbLoCut->get(), butterworthQ));
+	filters.setCoefficients (hiCut, Coefs::makeLowPass (samplerate, parameters.reverbHiCut->get(), butterworthQ));
+}
+
+template <typename SampleType>
+void Reverb<SampleType>::processConvolution (AudioBuffer& audio)
+{
+	const auto numSamples = audio.getNumSamples();
+
+	jassert (numSamples <= wet.getNumSamples());
+
+	auto* const* wetChans = wet.getArrayOfWritePointers();
+
+	for (auto chan = 0; chan < 2; ++chan)
+	{
+		const auto* in = audio.getReadPointer (std::min (chan, audio.getNumChannels() - 1));
+		std::transform (in, in + numSamples, wetChans[chan], [] (SampleType s) { return static_cast<float> (s); });
 	}
-	else
+
+	convolution.process (wetChans, numSamples);
+
+	filters.process ({ wetChans[0], wetChans[1], unusedLanes.getWritePointer (0), unusedLanes.getWritePointer (1) }, numSamples);
+
+	auto* left	= wetChans[0];
+	auto* right = wetChans[1];
+
+	auto* dryLeft  = audio.getWritePointer (0);
+	auto* dryRight = audio.getWritePointer (std::min (1, audio.getNumChannels() - 1));
+
+	const auto dryGain = static_cast<SampleType> (1.f - mix);
+
+	for (auto i = 0; i < numSamples; ++i)
 	{
-		meters.reverbLevel->set (-60.f);
+		// the wet signal is ducked by an envelope follower on the dry signal
+		const auto level = static_cast<float> (std::max (std::abs (dryLeft[i]), std::abs (dryRight[i])));
+		const auto coef	 = level > duckEnvelope ? duckAttack : duckRelease;
+
+		duckEnvelope = level + coef * (duckEnvelope - level);
+
+		const auto wetGain = mix * (1.f - duck * std::min (1.f, duckEnvelope));
+
+		const auto mid	= (left[i] + right[i]) * 0.5f;
+		const auto side = (left[i] - right[i]) * 0.5f * width;
+
+		left[i]	 = (mid + side) * wetGain;
+		right[i] = (mid - side) * wetGain;
+
+		dryLeft[i]	= dryLeft[i] * dryGain + static_cast<SampleType> (left[i]);
+		dryRight[i] = dryRight[i] * dryGain + static_cast<SampleType> (right[i]);
 	}
+
+	if (! telemetry.isActive())
+		return;
+
+	const auto level = std::max (wet.getMagnitude (0, 0, numSamples), wet.getMagnitude (1, 0, numSamples));
+	telemetry.reportEffectLevel (TelemetryRecord::reverb, juce::Decibels::gainToDecibels (level, TelemetryRecord::floorDecibels));
 }
 
 template <typename SampleType>
-void Reverb<SampleType>::prepare (double samplerate, int blocksize)
+void Reverb<SampleType>::prepare (double newSamplerate, int blocksize)
 {
+	samplerate = newSamplerate;
+
 	reverb.prepare (blocksize, samplerate, 2);
+	convolution.prepare (samplerate);
+
+	// the renderer has no message loop, so the threads can't wait for the audio thread to ask for them
+	if (parameters.reverbConvolution->get())
+		convolution.startThreads();
+
+	wet.setSize (2, blocksize);
+	unusedLanes.setSize (2, blocksize);
+
+	duckAttack	= static_cast<float> (std::exp (-1000. / (duckAttackMs * samplerate)));
+	duckRelease = static_cast<float> (std::exp (-1000. / (duckReleaseMs * samplerate)));
+
+	lastVersion = 0;
+
+	reset();
+}
+
+template <typename SampleType>
+void Reverb<SampleType>::reset()
+{
+	convolution.reset();
+	filters.reset();
+
+	duckEnvelope = 0.f;
 }
 
 template <typename SampleType>
-void Reverb<SampleType>::setWidth (float width)
+void Reverb<SampleType>::setWidth (float newWidth)
 {
-	reverb.setWidth (width);
+	width = newWidth;
+	reverb.setWidth (newWidth);
 }
 
 template struct Reverb<float>;
@@ -1,7 +1,14 @@
 #pragma once
 
+#include "BiquadCascade.h"
+#include "Convolution/ConvolutionReverb.h"
+
 namespace Imogen
 {
+/* The algorithmic reverb, or a convolution reverb once an impulse response has been loaded and
+   convolution is switched on. The mix, duck, lo cut and hi cut controls apply to both;
+   decay only applies to the algorithmic reverb.
+ */
 template <typename SampleType>
 struct Reverb
 {
@@ -13,15 +20,45 @@ struct Reverb
 
 	void prepare (double samplerate, int blocksize);
 
+	/* Clears the convolution reverb's tail, so that it can be woken up cleanly after being bypassed. */
+	void reset();
+
 	void setWidth (float width);
 
 private:
 
+	void updateSettings();
+
+	void processConvolution (AudioBuffer& audio);
+
 	State&		 state;
 	ReverbState& parameters { state.parameters.reverbState };
-	Meters&		 meters { state.meters };
+	Telemetry&	 telemetry { state.telemetry };
 
 	dsp::FX::Reverb reverb;
+
+	ConvolutionReverb convolution { state.customData };
+
+	enum Filter
+	{
+		loCut,
+		hiCut,
+		numFilters
+	};
+
+	BiquadCascade<float> filters { numFilters };
+
+	juce::AudioBuffer<float> wet, unusedLanes;
+
+	double samplerate { 0. };
+
+	float mix { 0.f }, duck { 0.f }, width { 1.f };
+	float duckEnvelope { 0.f }, duckAttack { 0.f }, duckRelease { 0.f };
+
+	juce::uint32 lastVersion { 0 };
+
+	static constexpr auto duckAttackMs	= 10.;
+	static constexpr auto duckReleaseMs = 250.;
 };
 
 }  // namespace Imogen
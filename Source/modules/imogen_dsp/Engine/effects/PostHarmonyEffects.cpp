@@ -10,31 +10,68 @@ template <typename SampleType>
 void PostHarmonyEffects<SampleType>::prepare (double samplerate, int blocksize)
 {
 	eq.prepare (samplerate, blocksize);
-	compressor.prepare (samplerate, blocksize);
-	deEsser.prepare (samplerate, blocksize);
+	dynamics.prepare (samplerate, blocksize);
 
 	dryWetMixer.prepare (samplerate, blocksize);
 	delay.prepare (samplerate, blocksize);
 	reverb.prepare (samplerate, blocksize);
 	outputGain.prepare (samplerate, blocksize);
 	limiter.prepare (samplerate, blocksize);
+
+	mixTail.prepare (samplerate, filterTailSeconds);
+	delayTail.prepare (samplerate, delayTailSeconds);
+	reverbTail.prepare (samplerate, reverbTailSeconds);
+	outputTail.prepare (samplerate, filterTailSeconds);
+}
+
+template <typename SampleType>
+void PostHarmonyEffects<SampleType>::process (AudioBuffer& harmonySignal, AudioBuffer& drySignal, AudioBuffer& output,
+											  bool inputsAreSilent)
+{
+	// the mixer leaves its output in the harmony signal
+	auto silent = processUnlessIdle (mixTail, harmonySignal, inputsAreSilent, [&]
+									 {
+										 eq.process (drySignal, harmonySignal);
+										 dynamics.process (drySignal, harmonySignal);
+
+										 dryWetMixer.process (drySignal, harmonySignal);
+									 });
+
+	silent = processUnlessIdle (delayTail, harmonySignal, silent, [&]
+								{ delay.process (harmonySignal); });
+
+	// the convolution tail would otherwise pick up where it left off when the reverb went idle
+	if (! silent && reverbTail.isIdle())
+		reverb.reset();
+
+	silent = processUnlessIdle (reverbTail, harmonySignal, silent, [&]
+								{ reverb.process (harmonySignal); });
+
+	silent = processUnlessIdle (outputTail, harmonySignal, silent, [&]
+								{
+									outputGain.process (harmonySignal);
+									limiter.process (harmonySignal);
+								});
+
+	if (! silent)
+		dsp::buffers::copy (harmonySignal, output);
 }
 
+/* Runs a stage unless both its input and its tail are silent, and returns whether its output was. */
 template <typename SampleType>
-void PostHarmonyEffects<SampleType>::process (AudioBuffer& harmonySignal, AudioBuffer& drySignal, AudioBuffer& output)
+template <typename Callback>
+bool PostHarmonyEffects<SampleType>::processUnlessIdle (TailTracker& tail, AudioBuffer& audio, bool inputIsSilent, Callback&& process)
 {
-	eq.process (drySignal, harmonySignal);
-	compressor.process (drySignal, harmonySignal);
-	deEsser.process (drySignal, harmonySignal);
+	if (inputIsSilent && tail.isIdle())
+		return true;
+
+	process();
 
-	dryWetMixer.process (drySignal, harmonySignal);
+	const auto outputIsSilent = isSilent (audio);
 
-	delay.process (harmonySignal);
-	reverb.process (harmonySignal);
-	outputGain.process (harmonySignal);
-	limiter.process (harmonySignal);
+	tail.update (inputIsSilent && outputIsSilent, audio.getNumSamples());
 
-	dsp::buffers::copy (harmonySignal, output);
+	return outputIsSilent;
 }
 
 template <typename SampleType>
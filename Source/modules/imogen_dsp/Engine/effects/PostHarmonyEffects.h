@@ -2,13 +2,14 @@
 
 #include <lemons_audio_effects/lemons_audio_effects.h>
 
+#include <imogen_dsp/Engine/Silence.h>
+
 #include "PreHarmony/StereoReducer.h"
 #include "PreHarmony/InputGain.h"
 #include "PreHarmony/NoiseGate.h"
 
 #include "PostHarmony/EQ.h"
-#include "PostHarmony/Compressor.h"
-#include "PostHarmony/DeEsser.h"
+#include "PostHarmony/Dynamics.h"
 #include "PostHarmony/DryWetMixer.h"
 #include "PostHarmony/Delay.h"
 #include "PostHarmony/Reverb.h"
@@ -28,24 +29,38 @@ public:
 
 	void prepare (double samplerate, int blocksize);
 
-	void process (AudioBuffer& harmonySignal, AudioBuffer& drySignal, AudioBuffer& output);
+	/* inputsAreSilent should be true if both the harmony and dry signals are silent. Stages whose
+	   input is silent are skipped once their tails have died away.
+	 */
+	void process (AudioBuffer& harmonySignal, AudioBuffer& drySignal, AudioBuffer& output, bool inputsAreSilent);
 
 	void updateStereoWidth (int width);
 
+	/* The limiter's lookahead. Only valid after prepare(). */
+	int getLatencySamples() const noexcept { return limiter.getLatencySamples(); }
+
 private:
 
+	template <typename Callback>
+	static bool processUnlessIdle (TailTracker& tail, AudioBuffer& audio, bool inputIsSilent, Callback&& process);
+
 	State&		state;
 	Parameters& parameters { state.parameters };
 
-	EQ<SampleType>		   eq { parameters.eqState };
-	Compressor<SampleType> compressor { state };
-	DeEsser<SampleType>	   deEsser { state };
+	EQ<SampleType>		 eq { parameters.eqState };
+	Dynamics<SampleType> dynamics { state };
 
 	DryWetMixer<SampleType> dryWetMixer { parameters };
 	Delay<SampleType>		delay { state };
 	Reverb<SampleType>		reverb { state };
 	OutputGain<SampleType>	outputGain { parameters };
 	Limiter<SampleType>		limiter { state };
+
+	// a delay only goes quiet for good once it has been silent for longer than its delay line
+	static constexpr auto delayTailSeconds	= Delay<SampleType>::maxDelaySeconds + 0.5;
+	static constexpr auto reverbTailSeconds = 0.25;
+
+	TailTracker mixTail, delayTail, reverbTail, outputTail;
 };
 
 }  // namespace Imogen
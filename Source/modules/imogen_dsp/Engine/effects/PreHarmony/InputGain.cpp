@@ -11,8 +11,6 @@ void InputGain<SampleType>::process (AudioBuffer& audio)
 {
 	gain.setGain (parameters.inputGain->get());
 	gain.process (audio);
-
-	meters.inputLevel->set (static_cast<float> (audio.getRMSLevel (0, 0, audio.getNumSamples())));
 }
 
 template <typename SampleType>
@@ -18,7 +18,6 @@ private:
 
 	State&		state;
 	Parameters& parameters { state.parameters };
-	Meters&		meters { state.meters };
 
 	dsp::FX::SmoothedGain<SampleType, 1> gain;
 };
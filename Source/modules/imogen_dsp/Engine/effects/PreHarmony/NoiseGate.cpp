@@ -12,24 +12,60 @@ NoiseGate<SampleType>::NoiseGate (State& stateToUse) : state (stateToUse)
 template <typename SampleType>
 void NoiseGate<SampleType>::process (AudioBuffer& audio)
 {
+	const auto numSamples = audio.getNumSamples();
+
 	if (parameters.noiseGateToggle->get())
 	{
-		gate.setThreshold (parameters.noiseGateThresh->get());
+		const auto threshold = parameters.noiseGateThresh->get();
+
+		const auto peak = juce::Decibels::gainToDecibels (static_cast<float> (audio.getMagnitude (0, 0, numSamples)));
+
+		gate.setThreshold (threshold);
+		updateRelease();
 
 		gate.process (audio);
 
-		meters.gateRedux->set (static_cast<float> (gate.getAverageGainReduction()));
+		closeTracker.update (peak < threshold, numSamples);
+		closed = closeTracker.isIdle();
+
+		if (closed)
+			audio.clear();
+
+		telemetry.reportGainReduction (TelemetryRecord::noiseGate, static_cast<float> (gate.getAverageGainReduction()));
 	}
 	else
 	{
-		meters.gateRedux->set (0.f);
+		closeTracker.reset();
+		closed = false;
 	}
 }
 
 template <typename SampleType>
-void NoiseGate<SampleType>::prepare (double samplerate, int blocksize)
+void NoiseGate<SampleType>::prepare (double newSamplerate, int blocksize)
 {
+	samplerate = newSamplerate;
+
 	gate.prepare (samplerate, blocksize);
+
+	releaseSeconds = -1.f;
+	updateRelease();
+
+	closed = false;
+}
+
+/* The gate only closes completely once it has had time to release, so the close tracker waits as long. */
+template <typename SampleType>
+void NoiseGate<SampleType>::updateRelease()
+{
+	const auto release = parameters.noiseGateRelease->get();
+
+	if (release == releaseSeconds)
+		return;
+
+	releaseSeconds = release;
+
+	gate.setRelease (static_cast<SampleType> (release * 1000.f));
+	closeTracker.prepare (samplerate, static_cast<double> (release));
 }
 
 template struct NoiseGate<float>;
@@ -13,13 +13,26 @@ struct NoiseGate
 
 	void prepare (double samplerate, int blocksize);
 
+	/* True once the input has stayed under the threshold for longer than the gate's release.
+	   From then on, the gate's output is digital silence.
+	 */
+	bool isClosed() const noexcept { return closed; }
+
 private:
 
+	void updateRelease();
+
 	State&		state;
 	Parameters& parameters { state.parameters };
-	Meters&		meters { state.meters };
+	Telemetry&	telemetry { state.telemetry };
 
 	dsp::FX::NoiseGate<SampleType> gate;
+
+	double samplerate { 0. };
+	float  releaseSeconds { -1.f };
+
+	TailTracker closeTracker;
+	bool		closed { false };
 };
 
 }  // namespace Imogen
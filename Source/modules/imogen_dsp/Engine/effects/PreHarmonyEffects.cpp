@@ -16,15 +16,33 @@ void PreHarmonyEffects<SampleType>::prepare (double samplerate, int blocksize)
 	initialLoCut.prepare (samplerate, blocksize);
 	inputGain.prepare (samplerate, blocksize);
 	gate.prepare (samplerate, blocksize);
+
+	inputTail.prepare (samplerate, filterTailSeconds);
+	inputIsSilent = false;
 }
 
 template <typename SampleType>
 void PreHarmonyEffects<SampleType>::process (const AudioBuffer& input)
 {
+	const auto hostInputIsSilent = isSilent (input);
+
+	if (hostInputIsSilent && inputTail.isIdle())
+	{
+		if (! inputIsSilent)
+			processedMonoBuffer.clear();
+
+		inputIsSilent = true;
+		return;
+	}
+
 	stereoReducer.process (input, processedMonoBuffer);
 	initialLoCut.process (processedMonoBuffer);
 	inputGain.process (processedMonoBuffer);
 	gate.process (processedMonoBuffer);
+
+	inputIsSilent = gate.isClosed() || isSilent (processedMonoBuffer.getReadPointer (0), input.getNumSamples());
+
+	inputTail.update (hostInputIsSilent && inputIsSilent, input.getNumSamples());
 }
 
 template <typename SampleType>
@@ -17,6 +17,14 @@ public:
 
 	const SampleType* getProcessedInputSignal() const;
 
+	/* True if the processed input for the last block was silent, either because the gate was
+	   closed or because there was nothing coming in.
+	 */
+	bool isInputSilent() const noexcept { return inputIsSilent; }
+
+	/* None of the input effects look ahead. */
+	int getLatencySamples() const noexcept { return 0; }
+
 private:
 
 	AudioBuffer processedMonoBuffer;
@@ -27,6 +35,9 @@ private:
 	dsp::FX::Filter<SampleType> initialLoCut { dsp::FX::FilterType::HighPass, 65.f };
 	InputGain<SampleType>		inputGain { state };
 	NoiseGate<SampleType>		gate { state };
+
+	TailTracker inputTail;
+	bool		inputIsSilent { false };
 };
 
 }  // namespace Imogen
@@ -7,6 +7,75 @@ Processor::Processor()
 											.withInput (TRANS ("Sidechain"), juce::AudioChannelSet::mono(), false)
 											.withOutput (TRANS ("Output"), juce::AudioChannelSet::stereo(), true))
 {
+	getState().presets.openWhenNeeded (PresetLibrary::getDefaultFile(), getParameters());
+}
+
+void Processor::processBlock (juce::AudioBuffer<float>& audio, MidiBuffer& midi)
+{
+	updateHostTempo();
+	plugin::Processor<State, Engine>::processBlock (audio, midi);
+}
+
+void Processor::processBlock (juce::AudioBuffer<double>& audio, MidiBuffer& midi)
+{
+	updateHostTempo();
+	plugin::Processor<State, Engine>::processBlock (audio, midi);
+}
+
+/* Hosts ask for the state on every autosave, for every instance, so it's written in a compact binary
+   form into a buffer that's kept between calls, instead of building and printing an XML tree.
+ */
+void Processor::getStateInformation (juce::MemoryBlock& block)
+{
+	const auto size = stateChunk.write();
+
+	block.replaceAll (stateChunk.getData(), size);
+}
+
+void Processor::setStateInformation (const void* data, int size)
+{
+	if (size <= 0)
+		return;
+
+	if (StateChunk::isStateChunk (data, static_cast<size_t> (size)))
+		stateChunk.restore (data, static_cast<size_t> (size));
+	else
+		setStateFromXml (data, size);
+}
+
+void Processor::getStateAsXml (juce::MemoryBlock& block)
+{
+	plugin::Processor<State, Engine>::getStateInformation (block);
+}
+
+void Processor::setStateFromXml (const void* data, int size)
+{
+	plugin::Processor<State, Engine>::setStateInformation (data, size);
+}
+
+void Processor::updateHostTempo()
+{
+	auto* playHead = getPlayHead();
+
+	if (playHead == nullptr)
+		return;
+
+	juce::AudioPlayHead::CurrentPositionInfo info;
+
+	if (playHead->getCurrentPosition (info) && info.bpm > 0.)
+		getState().tempo.store (info.bpm, std::memory_order_relaxed);
+}
+
+void Processor::handleAsyncUpdate()
+{
+	const auto samplerate = getSampleRate();
+
+	if (samplerate <= 0.)
+		return;
+
+	suspendProcessing (true);
+	prepareToPlay (samplerate, getBlockSize());
+	suspendProcessing (false);
 }
 
 double Processor::getTailLengthSeconds() const
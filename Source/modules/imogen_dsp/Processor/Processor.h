@@ -6,13 +6,28 @@
 namespace Imogen
 {
 class Processor : public plugin::Processor<State, Engine>
+	, private juce::AsyncUpdater
 {
 public:
 
 	Processor();
 
+	void processBlock (juce::AudioBuffer<float>& audio, MidiBuffer& midi) final;
+	void processBlock (juce::AudioBuffer<double>& audio, MidiBuffer& midi) final;
+
+	void getStateInformation (juce::MemoryBlock& block) final;
+	void setStateInformation (const void* data, int size) final;
+
+	/* The generic XML form of the state, which sessions saved before the binary chunk still use. */
+	void getStateAsXml (juce::MemoryBlock& block);
+	void setStateFromXml (const void* data, int size);
+
 private:
 
+	void updateHostTempo();
+
+	void handleAsyncUpdate() final;
+
 	bool canAddBus (bool isInput) const override final { return isInput; }
 	bool isBusesLayoutSupported (const BusesLayout& layouts) const final;
 
@@ -27,6 +42,19 @@ private:
 	juce::StringArray getAlternateDisplayNames() const final { return { "Imgn" }; }
 
 	Parameters& parameters { getState().parameters };
+	Internals&	internals { getState().internals };
+
+	StateChunk stateChunk { getState(), getParameters() };
+
+	// the latency can only change while the engine is being prepared, which has to happen on the message thread
+	plugin::ParamUpdater lowLatencyUpdater { internals.lowLatencyMode, [this]
+											 { triggerAsyncUpdate(); } };
+
+	plugin::ParamUpdater pitchFloorUpdater { internals.lowLatencyPitchFloor, [this]
+											 {
+												 if (internals.lowLatencyMode->get())
+													 triggerAsyncUpdate();
+											 } };
 
 	// network::OscDataSynchronizer dataSync {state};
 };
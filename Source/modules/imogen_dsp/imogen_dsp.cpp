@@ -2,23 +2,37 @@
 #include "imogen_dsp.h"
 
 
+#include "Engine/Silence.cpp"
+#include "Engine/Levels.cpp"
+
 #include "Engine/effects/PreHarmony/StereoReducer.cpp"
 #include "Engine/effects/PreHarmony/InputGain.cpp"
 #include "Engine/effects/PreHarmony/NoiseGate.cpp"
 #include "Engine/effects/PreHarmonyEffects.cpp"
 
+#include "Engine/PSOLA/PitchDetector.cpp"
+#include "Engine/PSOLA/OverlapAdd.cpp"
+#include "Engine/PSOLA/GrainCache.cpp"
+#include "Engine/PSOLA/GrainShifter.cpp"
+
+#include "Engine/Harmonizer/VoiceRenderPool.cpp"
+#include "Engine/Harmonizer/VoiceAllocator.cpp"
 #include "Engine/Harmonizer/Harmonizer.cpp"
 #include "Engine/Harmonizer/HarmonizerVoice.cpp"
 
 #include "Engine/Lead/LeadProcessor.cpp"
 #include "Engine/Lead/DryPanner.cpp"
 #include "Engine/Lead/PitchCorrector.cpp"
+#include "Engine/Lead/PitchToMidi.cpp"
 
+#include "Engine/effects/PostHarmony/BiquadCascade.cpp"
 #include "Engine/effects/PostHarmony/EQ.cpp"
-#include "Engine/effects/PostHarmony/Compressor.cpp"
-#include "Engine/effects/PostHarmony/DeEsser.cpp"
+#include "Engine/effects/PostHarmony/Dynamics.cpp"
 #include "Engine/effects/PostHarmony/DryWetMixer.cpp"
 #include "Engine/effects/PostHarmony/Delay.cpp"
+#include "Engine/effects/PostHarmony/Convolution/ImpulseResponse.cpp"
+#include "Engine/effects/PostHarmony/Convolution/PartitionedConvolver.cpp"
+#include "Engine/effects/PostHarmony/Convolution/ConvolutionReverb.cpp"
 #include "Engine/effects/PostHarmony/Reverb.cpp"
 #include "Engine/effects/PostHarmony/OutputGain.cpp"
 #include "Engine/effects/PostHarmony/Limiter.cpp"
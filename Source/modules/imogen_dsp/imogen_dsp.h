@@ -10,7 +10,7 @@
  version:            0.0.1
  name:               imogen_dsp
  description:        DSP module for Imogen
- dependencies:       lemons_synth lemons_psola imogen_state
+ dependencies:       juce_dsp juce_audio_formats lemons_synth lemons_psola imogen_state
 
  END_JUCE_MODULE_DECLARATION
 
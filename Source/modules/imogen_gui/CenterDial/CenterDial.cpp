@@ -53,6 +53,8 @@ void CenterDial::focusLost (FocusChangeType cause)
 
 void CenterDial::showParameter (plugin::Parameter& param)
 {
+	showingPitch = false;
+
 	mainText.set (param.getCurrentValueAsText());
 	description.set (param.getParameterName());
 
@@ -64,12 +66,40 @@ void CenterDial::showParameter (plugin::Parameter& param)
 
 void CenterDial::showPitchCorrection()
 {
-	mainText.set (state.internals.currentInputNote->getCurrentValueAsText());
+	showingPitch = true;
+
 	description.set (TRANS ("Pitch correction"));
 	leftEnd.set (TRANS ("Flat"));
 	rightEnd.set (TRANS ("Sharp"));
 
 	setTooltip (TRANS ("Pitch correction"));
+
+	showInputPitch (inputPitch);
+}
+
+void CenterDial::showInputPitch (float frequency)
+{
+	inputPitch = frequency;
+
+	if (! showingPitch)
+		return;
+
+	if (frequency <= 0.f)
+	{
+		mainText.set (TRANS ("Unpitched"));
+		return;
+	}
+
+	const auto midiPitch = 69.f + 12.f * std::log2 (frequency / 440.f);
+	const auto note		 = juce::roundToInt (midiPitch);
+	const auto cents	 = juce::roundToInt ((midiPitch - static_cast<float> (note)) * 100.f);
+
+	if (cents == 0)
+		mainText.set (pitchToString (note) + " - " + TRANS ("Perfect!"));
+	else if (cents > 0)
+		mainText.set (pitchToString (note) + " - " + String (cents) + TRANS (" cents sharp"));
+	else
+		mainText.set (pitchToString (note) + " - " + String (-cents) + TRANS (" cents flat"));
 }
 
 }  // namespace Imogen
@@ -24,8 +24,16 @@ private:
 	void showParameter (plugin::Parameter& param);
 	void showPitchCorrection();
 
+	/* Shows the note nearest the detected pitch and how far off it the singer is. */
+	void showInputPitch (float frequency);
+
 	State& state;
 
+	// false while a parameter is being shown instead
+	bool showingPitch { true };
+
+	float inputPitch { 0.f };
+
 	gui::Label mainText;
 	gui::Label description;
 	gui::Label leftEnd;
@@ -38,6 +46,10 @@ private:
 										{
 											if (! starting) showPitchCorrection();
 										} };
+
+	Telemetry::Listener telemetryListener { state.telemetry,
+											[&] (const TelemetryRecord& record)
+											{ showInputPitch (record.pitch); } };
 };
 
 }  // namespace Imogen
@@ -29,7 +29,7 @@ private:
 	Header		 header { state };
 	CenterDial	 dial { state };
 	DryWet		 dryWet { state };
-	MidiKeyboard keyboard;
+	MidiKeyboard keyboard { state };
 };
 
 }  // namespace Imogen
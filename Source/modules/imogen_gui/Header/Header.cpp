@@ -4,8 +4,7 @@ namespace Imogen
 Header::Header (State& stateToUse)
 	: state (stateToUse)
 {
-	gui::addAndMakeVisible (this, logo, inputIcon, outputLevel, scale, keyboardButton);
-	// presetBar
+	gui::addAndMakeVisible (this, logo, inputIcon, outputLevel, scale, keyboardButton, presets);
 }
 
 void Header::paint (juce::Graphics&)
@@ -14,7 +13,7 @@ void Header::paint (juce::Graphics&)
 
 void Header::resized()
 {
-	// logo, keyboardButton, input icon, outputLevel, presetBar, scale
+	// logo, keyboardButton, input icon, outputLevel, presets, scale
 }
 
 }  // namespace Imogen
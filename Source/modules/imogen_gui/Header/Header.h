@@ -3,6 +3,7 @@
 #include "InputIcon.h"
 #include "OutputLevel/OutputLevel.h"
 #include "ScaleChooser.h"
+#include "PresetChooser.h"
 #include "AboutPopup/LogoButton.h"
 #include "MidiSettings/KeyboardButton.h"
 
@@ -28,7 +29,7 @@ private:
 	InputIcon	inputIcon { state };
 	OutputLevel outputLevel { state };
 
-	// plugin::PresetBar presetBar {state, "Imogen", ".imogenpreset"};
+	PresetChooser presets { state.presets };
 
 	ScaleChooser scale { state.internals };
 };
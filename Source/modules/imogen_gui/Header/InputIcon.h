@@ -15,9 +15,16 @@ private:
 
 	State& state;
 
-	plugin::GainMeterParameter& inputMeter { *state.meters.inputLevel };
-
 	plugin::GainParameter& inputGain { *state.parameters.inputGain };
+
+	float inputLevel { 0.f };
+
+	Telemetry::Listener telemetryListener { state.telemetry,
+											[&] (const TelemetryRecord& record)
+											{
+												inputLevel = record.rms[TelemetryRecord::input];
+												repaint();
+											} };
 };
 
 }  // namespace Imogen
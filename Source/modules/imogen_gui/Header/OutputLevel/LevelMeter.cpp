@@ -1,8 +1,12 @@
 
 namespace Imogen
 {
-OutputLevelMeter::OutputLevelMeter (Meters& metersToUse)
-	: meters (metersToUse)
+OutputLevelMeter::OutputLevelMeter (Telemetry& telemetryToUse)
+	: telemetryListener (telemetryToUse, [&] (const TelemetryRecord& record)
+						 {
+							 left.setLevel (record.rms[TelemetryRecord::outputLeft]);
+							 right.setLevel (record.rms[TelemetryRecord::outputRight]);
+						 })
 {
 }
 
@@ -15,10 +19,13 @@ void OutputLevelMeter::resized()
 }
 
 
-OutputLevelMeter::Bar::Bar (plugin::GainMeterParameter& meter)
-	: level (meter)
+void OutputLevelMeter::Bar::setLevel (float newLevel)
 {
-	juce::ignoreUnused (level);
+	if (newLevel == level)
+		return;
+
+	level = newLevel;
+	repaint();
 }
 
 void OutputLevelMeter::Bar::paint (juce::Graphics&)
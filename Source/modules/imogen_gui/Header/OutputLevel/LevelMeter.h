@@ -7,29 +7,28 @@ class OutputLevelMeter : public juce::Component
 {
 public:
 
-	OutputLevelMeter (Meters& metersToUse);
+	OutputLevelMeter (Telemetry& telemetryToUse);
 
 private:
 
 	struct Bar : juce::Component
 	{
-		Bar (plugin::GainMeterParameter& meter);
+		void setLevel (float newLevel);
 
 	private:
 
 		void paint (juce::Graphics& g) final;
 		void resized() final;
 
-		plugin::GainMeterParameter& level;
+		float level { 0.f };
 	};
 
 	void paint (juce::Graphics& g) final;
 	void resized() final;
 
-	Meters& meters;
+	Bar left, right;
 
-	Bar left { *meters.outputLevelL };
-	Bar right { *meters.outputLevelR };
+	Telemetry::Listener telemetryListener;
 };
 
 }  // namespace Imogen
@@ -18,7 +18,7 @@ private:
 
 	State& state;
 
-	OutputLevelMeter meter { state.meters };
+	OutputLevelMeter meter { state.telemetry };
 	OutputLevelThumb thumb { state.parameters };
 };
 
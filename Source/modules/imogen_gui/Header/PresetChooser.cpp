@@ -0,0 +1,53 @@
+
+namespace Imogen
+{
+PresetChooser::PresetChooser (PresetLibrary& libraryToUse)
+	: library (libraryToUse)
+{
+	list.setTextWhenNoChoicesAvailable (TRANS ("No presets"));
+	list.setTextWhenNothingSelected (TRANS ("Presets"));
+
+	list.onChange = [this]
+	{
+		if (const auto index = list.getSelectedItemIndex(); index >= 0)
+			library.select (index);
+	};
+
+	saveButton.onClick = [this]
+	{ saveCurrent(); };
+
+	gui::addAndMakeVisible (this, list, saveButton);
+
+	refresh();
+}
+
+void PresetChooser::refresh()
+{
+	list.clear (juce::dontSendNotification);
+
+	for (auto i = 0; i < library.getNumPresets(); ++i)
+		list.addItem (library.getPresetName (i), i + 1);
+
+	list.setSelectedItemIndex (library.getSelectedPreset(), juce::dontSendNotification);
+}
+
+void PresetChooser::saveCurrent()
+{
+	const auto name = TRANS ("Preset") + " " + String (library.getNumPresets() + 1);
+
+	if (library.addPreset (name))
+	{
+		refresh();
+		list.setSelectedItemIndex (library.getNumPresets() - 1, juce::dontSendNotification);
+	}
+}
+
+void PresetChooser::resized()
+{
+	auto bounds = getLocalBounds();
+
+	saveButton.setBounds (bounds.removeFromRight (bounds.getHeight() * 2));
+	list.setBounds (bounds);
+}
+
+}  // namespace Imogen
@@ -0,0 +1,27 @@
+#pragma once
+
+namespace Imogen
+{
+/* Lists the presets in the library and switches to the one picked. Switching never waits on the
+   audio thread, so it's safe to do mid-performance.
+ */
+class PresetChooser : public juce::Component
+{
+public:
+
+	PresetChooser (PresetLibrary& libraryToUse);
+
+	void resized() final;
+
+private:
+
+	void refresh();
+	void saveCurrent();
+
+	PresetLibrary& library;
+
+	juce::ComboBox	 list;
+	juce::TextButton saveButton { TRANS ("Save") };
+};
+
+}  // namespace Imogen
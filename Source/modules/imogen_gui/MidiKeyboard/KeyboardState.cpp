@@ -0,0 +1,25 @@
+
+namespace Imogen
+{
+KeyboardState::KeyboardState (State& stateToUse)
+	: queue (stateToUse.midiInput)
+{
+	addListener (this);
+}
+
+KeyboardState::~KeyboardState()
+{
+	removeListener (this);
+}
+
+void KeyboardState::handleNoteOn (juce::MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity)
+{
+	queue.push (juce::MidiMessage::noteOn (midiChannel, midiNoteNumber, velocity));
+}
+
+void KeyboardState::handleNoteOff (juce::MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity)
+{
+	queue.push (juce::MidiMessage::noteOff (midiChannel, midiNoteNumber, velocity));
+}
+
+}  // namespace Imogen
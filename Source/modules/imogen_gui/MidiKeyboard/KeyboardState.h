@@ -1 +1,25 @@
 #pragma once
+
+namespace Imogen
+{
+/* The on-screen keyboard's state, which passes every note played on it to the engine through the
+   state's MIDI input queue.
+ */
+class KeyboardState : public juce::MidiKeyboardState
+	, private juce::MidiKeyboardState::Listener
+{
+public:
+
+	KeyboardState (State& stateToUse);
+
+	virtual ~KeyboardState() override;
+
+private:
+
+	void handleNoteOn (juce::MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity) final;
+	void handleNoteOff (juce::MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity) final;
+
+	MidiInputQueue& queue;
+};
+
+}  // namespace Imogen
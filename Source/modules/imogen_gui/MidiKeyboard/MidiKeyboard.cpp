@@ -0,0 +1,15 @@
+
+namespace Imogen
+{
+MidiKeyboard::MidiKeyboard (State& stateToUse)
+	: keyboardState (stateToUse)
+{
+	addAndMakeVisible (keyboard);
+}
+
+void MidiKeyboard::resized()
+{
+	keyboard.setBounds (getLocalBounds());
+}
+
+}  // namespace Imogen
@@ -8,7 +8,15 @@ class MidiKeyboard : public juce::Component
 {
 public:
 
+	MidiKeyboard (State& stateToUse);
+
+	void resized() final;
+
 private:
+
+	KeyboardState keyboardState;
+
+	juce::MidiKeyboardComponent keyboard { keyboardState, juce::MidiKeyboardComponent::horizontalKeyboard };
 };
 
 }  // namespace Imogen
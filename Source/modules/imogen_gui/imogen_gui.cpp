@@ -4,6 +4,7 @@
 #include "CenterDial/CenterDial.cpp"
 
 #include "Header/ScaleChooser.cpp"
+#include "Header/PresetChooser.cpp"
 #include "Header/OutputLevel/LevelMeter.cpp"
 #include "Header/OutputLevel/Thumb.cpp"
 #include "Header/OutputLevel/OutputLevel.cpp"
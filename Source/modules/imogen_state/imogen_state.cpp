@@ -1,3 +1,9 @@
 #include "imogen_state.h"
 
 #include "state/State.cpp"
+#include "state/StageTimings.cpp"
+#include "state/LatencyBudget.cpp"
+#include "state/MidiInputQueue.cpp"
+#include "state/Telemetry.cpp"
+#include "state/PresetLibrary.cpp"
+#include "state/StateChunk.cpp"
@@ -25,3 +25,4 @@ using namespace lemons;
 }
 
 #include "state/State.h"
+#include "state/StateChunk.h"
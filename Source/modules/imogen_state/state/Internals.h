@@ -23,24 +23,24 @@ struct Internals
 
 	BoolParam guiDarkMode { true, "GUI Dark mode" };
 
-	IntParam currentInputNote { -1, 127, -1, "Current input note",
-								[] (int note, int maxLength)
-								{
-									if (note == -1) return juce::String ("Unpitched");
-									return pitchToString (note).substring (0, maxLength);
-								} };
-
-	IntParam currentCentsSharp { -100, 100, 0, "Current input cents sharp",
-								 [] (int cents, int maxLength)
-								 {
-									 if (cents == 0) return TRANS ("Perfect!");
-
-									 if (cents > 0) return (juce::String (cents) + TRANS (" cents sharp")).substring (0, maxLength);
-
-									 return (juce::String (abs (cents)) + TRANS (" cents flat")).substring (0, maxLength);
-								 },
-								 nullptr,
-								 TRANS ("cents") };
+	static constexpr auto maxVoices = 128;
+
+	IntParam numVoices { 1, maxVoices, 16, "Number of voices" };
+
+	IntParam voiceRenderThreads { 0, 8, 0, "Voice render threads" };
+
+	/* Low latency mode shortens the analysis window by raising the lowest pitch that can be tracked.
+	   Changing either of these re-prepares the engine, and the new latency is reported to the host.
+	 */
+	static constexpr auto normalPitchFloor = 60;
+
+	ToggleParam lowLatencyMode { "Low latency mode", false };
+
+	IntParam lowLatencyPitchFloor { normalPitchFloor, 400, 150, "Low latency pitch floor",
+									[] (int hz, int maxLength)
+									{ return (juce::String (hz) + " Hz").substring (0, maxLength); },
+									nullptr,
+									TRANS ("Hz") };
 
 private:
 
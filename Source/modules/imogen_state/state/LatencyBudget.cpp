@@ -0,0 +1,37 @@
+
+namespace Imogen
+{
+void LatencyBudget::set (EngineStage stage, int samples) noexcept
+{
+	jassert (samples >= 0);
+
+	latencies[static_cast<size_t> (stage)].store (samples, std::memory_order_relaxed);
+}
+
+int LatencyBudget::get (EngineStage stage) const noexcept
+{
+	return latencies[static_cast<size_t> (stage)].load (std::memory_order_relaxed);
+}
+
+int LatencyBudget::getTotal() const noexcept
+{
+	auto total = 0;
+
+	for (const auto& latency : latencies)
+		total += latency.load (std::memory_order_relaxed);
+
+	return total;
+}
+
+EngineStage LatencyBudget::getLargestStage() const noexcept
+{
+	auto largest = EngineStage::preHarmonyEffects;
+
+	for (size_t i = 1; i < StageTimings::numStages; ++i)
+		if (latencies[i].load (std::memory_order_relaxed) > get (largest))
+			largest = static_cast<EngineStage> (i);
+
+	return largest;
+}
+
+}  // namespace Imogen
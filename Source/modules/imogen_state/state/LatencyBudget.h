@@ -0,0 +1,26 @@
+#pragma once
+
+namespace Imogen
+{
+/* The latency each engine stage adds to the signal, declared by the engine every time it is
+   prepared. The engine reports the total to the host; any thread may read the breakdown.
+ */
+class LatencyBudget
+{
+public:
+
+	void set (EngineStage stage, int samples) noexcept;
+
+	int get (EngineStage stage) const noexcept;
+
+	int getTotal() const noexcept;
+
+	/* The stage that adds the most latency, so that the GUI can show what to change to reduce it. */
+	EngineStage getLargestStage() const noexcept;
+
+private:
+
+	std::array<std::atomic<int>, StageTimings::numStages> latencies {};
+};
+
+}  // namespace Imogen
@@ -0,0 +1,148 @@
+
+namespace Imogen
+{
+MidiInputQueue::MidiInputQueue()
+	: ticksPerSecond (static_cast<double> (juce::Time::getHighResolutionTicksPerSecond()))
+{
+	for (size_t i = 0; i < slots.size(); ++i)
+		slots[i].sequence.store (i, std::memory_order_relaxed);
+}
+
+bool MidiInputQueue::push (const juce::MidiMessage& message)
+{
+	const auto clock = readClock();
+
+	return pushAt (message, estimateSamplePosition (clock) + (clock.blockEnd - clock.blockStart));
+}
+
+juce::int64 MidiInputQueue::estimateSamplePosition (const Clock& clock) const noexcept
+{
+	const auto rate = ticksPerSample.load (std::memory_order_relaxed);
+
+	if (rate <= 0.)
+		return clock.blockEnd;
+
+	const auto elapsed = static_cast<double> (juce::Time::getHighResolutionTicks()) - clock.origin;
+
+	// the engine can't be further on than the block it's rendering, and if it has stopped it isn't moving at all
+	return juce::jlimit (clock.blockStart, std::max (clock.blockStart, clock.blockEnd), static_cast<juce::int64> (elapsed / rate));
+}
+
+MidiInputQueue::Clock MidiInputQueue::readClock() const noexcept
+{
+	for (;;)
+	{
+		const auto sequence = clockSequence.load (std::memory_order_acquire);
+
+		if ((sequence & 1) != 0)
+			continue;
+
+		const Clock clock { blockStart.load (std::memory_order_relaxed),
+							blockEnd.load (std::memory_order_relaxed),
+							clockOrigin.load (std::memory_order_relaxed) };
+
+		std::atomic_thread_fence (std::memory_order_acquire);
+
+		if (clockSequence.load (std::memory_order_relaxed) == sequence)
+			return clock;
+	}
+}
+
+void MidiInputQueue::writeClock (const Clock& clock) noexcept
+{
+	const auto sequence = clockSequence.load (std::memory_order_relaxed);
+
+	clockSequence.store (sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence (std::memory_order_release);
+
+	blockStart.store (clock.blockStart, std::memory_order_relaxed);
+	blockEnd.store (clock.blockEnd, std::memory_order_relaxed);
+	clockOrigin.store (clock.origin, std::memory_order_relaxed);
+
+	clockSequence.store (sequence + 2, std::memory_order_release);
+}
+
+bool MidiInputQueue::pushAt (const juce::MidiMessage& message, juce::int64 samplePosition)
+{
+	const auto size = message.getRawDataSize();
+
+	if (size <= 0 || size > 3)
+		return false;
+
+	auto position = pushPosition.load (std::memory_order_relaxed);
+
+	Slot* slot;
+
+	for (;;)
+	{
+		slot = &slots[position & mask];
+
+		const auto sequence = slot->sequence.load (std::memory_order_acquire);
+		const auto diff		= static_cast<juce::int64> (sequence - position);
+
+		if (diff == 0)
+		{
+			if (pushPosition.compare_exchange_weak (position, position + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+		{
+			return false;  // the audio thread hasn't caught up with this slot yet
+		}
+		else
+		{
+			position = pushPosition.load (std::memory_order_relaxed);
+		}
+	}
+
+	auto& event = slot->event;
+
+	event.timestamp = samplePosition;
+	event.size		= size;
+	std::copy_n (message.getRawData(), size, event.data.begin());
+
+	slot->sequence.store (position + 1, std::memory_order_release);
+
+	return true;
+}
+
+void MidiInputQueue::prepare (double samplerate) noexcept
+{
+	ticksPerSample.store (ticksPerSecond / samplerate, std::memory_order_relaxed);
+}
+
+void MidiInputQueue::drain (MidiBuffer& destination, int numSamples) noexcept
+{
+	const auto start = blockEnd.load (std::memory_order_relaxed);
+	const auto end	 = start + numSamples;
+
+	const auto now = static_cast<double> (juce::Time::getHighResolutionTicks());
+
+	writeClock ({ start, end, now - static_cast<double> (start) * ticksPerSample.load (std::memory_order_relaxed) });
+
+	if (numSamples <= 0)
+		return;
+
+	for (;;)
+	{
+		auto& slot = slots[popPosition & mask];
+
+		// a push that has claimed this slot but not finished writing it is picked up next block
+		if (slot.sequence.load (std::memory_order_acquire) != popPosition + 1)
+			return;
+
+		const auto& event = slot.event;
+
+		if (event.timestamp >= end)
+			return;
+
+		const auto offset = static_cast<int> (juce::jlimit (juce::int64 (0), juce::int64 (numSamples - 1), event.timestamp - start));
+
+		destination.addEvent (event.data.data(), event.size, offset);
+
+		slot.sequence.store (popPosition + capacity, std::memory_order_release);
+		++popPosition;
+	}
+}
+
+}  // namespace Imogen
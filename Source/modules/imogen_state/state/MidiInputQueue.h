@@ -0,0 +1,101 @@
+#pragma once
+
+namespace Imogen
+{
+/* MIDI played from outside the host's MIDI stream: the on-screen keyboard, the remote app, or tests.
+   Any number of threads may push; only the audio thread drains, without locking or allocating.
+
+   Events are timestamped on the audio clock, which the audio thread publishes every time it
+   drains: a pushed event is given the sample position the engine is estimated to have reached,
+   plus the length of one block, so that it lands in the next block at the same distance from its
+   start as it was played from the start of the block being rendered. That keeps the spacing
+   between events however late the message thread gets to push them, at a fixed cost of one block.
+
+   Only messages of up to 3 bytes can be queued, so not sysex.
+ */
+class MidiInputQueue
+{
+public:
+
+	MidiInputQueue();
+
+	/* Returns false if the message couldn't be queued, because it's too long or the queue is full. */
+	bool push (const juce::MidiMessage& message);
+
+	/* Queues the message at an exact position on the audio clock, as returned by getSamplePosition(). */
+	bool pushAt (const juce::MidiMessage& message, juce::int64 samplePosition);
+
+	/* The start of the next block the engine will drain. */
+	juce::int64 getSamplePosition() const noexcept { return readClock().blockEnd; }
+
+	/* Called by the engine whenever it is prepared. */
+	void prepare (double samplerate) noexcept;
+
+	/* Called by the audio thread at the start of every block, to advance the audio clock and add
+	   every queued event that falls within the block to the buffer. Events due in later blocks are
+	   left in the queue, and anything that was due before this block is added at its first sample.
+	 */
+	void drain (MidiBuffer& destination, int numSamples) noexcept;
+
+	static constexpr auto capacity = 1024;
+
+	/* How much a MidiBuffer needs reserved to take a full queue in one drain: JUCE stores each event
+	   as its timestamp and size, followed by its data.
+	 */
+	static constexpr auto bufferBytes = capacity * static_cast<int> (sizeof (juce::int32) + sizeof (juce::uint16) + 3);
+
+private:
+
+	struct Event
+	{
+		juce::int64 timestamp { 0 };
+
+		std::array<juce::uint8, 3> data {};
+		int						   size { 0 };
+	};
+
+	struct Slot
+	{
+		// the number of pushes when this slot is free to be written, or that plus one when it's readable
+		std::atomic<juce::uint64> sequence { 0 };
+
+		Event event;
+	};
+
+	// the audio clock: where the last drained block started and ended, and the tick count at sample 0
+	struct Clock
+	{
+		juce::int64 blockStart, blockEnd;
+		double		origin;
+	};
+
+	/* The three values are published together under a sequence number, which is odd while the audio
+	   thread is writing them, so that a reader never mixes values from two different blocks. Readers
+	   retry until they get a consistent copy; the audio thread never waits.
+	 */
+	Clock readClock() const noexcept;
+	void  writeClock (const Clock& clock) noexcept;
+
+	juce::int64 estimateSamplePosition (const Clock& clock) const noexcept;
+
+	std::array<Slot, capacity> slots;
+
+	std::atomic<juce::uint64> pushPosition { 0 };
+
+	// only touched by the audio thread
+	juce::uint64 popPosition { 0 };
+
+	std::atomic<juce::uint32> clockSequence { 0 };
+	std::atomic<juce::int64>  blockStart { 0 }, blockEnd { 0 };
+	std::atomic<double>		  clockOrigin { 0. };
+
+	std::atomic<double> ticksPerSample { 0. };
+
+	const double ticksPerSecond;
+
+	static constexpr auto mask = static_cast<juce::uint64> (capacity - 1);
+
+	static_assert ((capacity & (capacity - 1)) == 0, "The capacity must be a power of 2");
+};
+
+}  // namespace Imogen
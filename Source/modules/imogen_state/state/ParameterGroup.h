@@ -0,0 +1,44 @@
+#pragma once
+
+namespace Imogen
+{
+/* A set of parameters with a shared version number, bumped whenever any of them changes.
+   Each reader keeps the last version it applied, so the audio thread can tell whether a whole
+   group of settings needs re-applying with a single atomic load.
+ */
+class ParameterGroup
+{
+public:
+
+	template <typename... ParamTypes>
+	void add (ParamTypes&... params)
+	{
+		(updaters.add (new plugin::ParamUpdater (params, [this]
+												 { markChanged(); })),
+		 ...);
+	}
+
+	void markChanged() noexcept { version.fetch_add (1, std::memory_order_release); }
+
+	/* True if the group has changed since lastSeenVersion, which is then brought up to date.
+	   A lastSeenVersion of 0 always counts as out of date.
+	 */
+	bool checkForChanges (juce::uint32& lastSeenVersion) const noexcept
+	{
+		const auto current = version.load (std::memory_order_acquire);
+
+		if (current == lastSeenVersion)
+			return false;
+
+		lastSeenVersion = current;
+		return true;
+	}
+
+private:
+
+	std::atomic<juce::uint32> version { 1 };
+
+	juce::OwnedArray<plugin::ParamUpdater> updaters;
+};
+
+}  // namespace Imogen
@@ -1,8 +1,10 @@
 
 #pragma once
 
+#include "ParameterGroup.h"
 #include "sublists/EQState.h"
 #include "sublists/ReverbState.h"
+#include "sublists/DelayState.h"
 #include "sublists/MidiState.h"
 
 namespace Imogen
@@ -11,6 +13,9 @@ struct Parameters : plugin::ParameterList
 {
 	Parameters();
 
+	/* Bumps every group's version, for when values were stored without notifying any listeners. */
+	void markAllChanged() noexcept;
+
 	IntParam inputMode { 1, 3, 1, "Input source",
 						 [] (int value, int maxLength)
 						 {
@@ -46,6 +51,7 @@ struct Parameters : plugin::ParameterList
 
 	ToggleParam noiseGateToggle { "Gate toggle", true };
 	dbParam		noiseGateThresh { "Gate thresh", -20.f };
+	SecParam	noiseGateRelease { 1.f, "Gate release", 0.1f };
 
 	ToggleParam	 deEsserToggle { "D-S toggle", true };
 	dbParam		 deEsserThresh { "D-S thresh", -6.f };
@@ -54,15 +60,18 @@ struct Parameters : plugin::ParameterList
 	ToggleParam	 compToggle { "Compressor toggle", false };
 	PercentParam compAmount { "Compressor amount", 50 };
 
-	ToggleParam	 delayToggle { "Delay toggle", false };
-	PercentParam delayDryWet { "Delay mix", 0 };
-
 	ToggleParam limiterToggle { "Limiter toggle", true };
+	dbParam		limiterCeiling { "Limiter ceiling", -1.f };
+	SecParam	limiterRelease { 1.f, "Limiter release", 0.05f };
+
+	ParameterGroup deEsserChanges, compChanges, limiterChanges;
 
 	EQState eqState { *this };
 
 	ReverbState reverbState { *this };
 
+	DelayState delayState;
+
 	MidiState midiState { *this };
 };
 
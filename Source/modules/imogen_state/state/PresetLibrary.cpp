@@ -0,0 +1,355 @@
+
+namespace Imogen
+{
+bool PresetLibrary::open (const juce::File& file, const Parameters& parametersToUse)
+{
+	// values applied from the contents about to be retired may still be waiting to be announced
+	timerCallback();
+
+	parameters	 = parametersToUse;
+	libraryFile	 = file;
+	needsOpening = false;
+
+	// the processor's parameters never change, so this is only resized before anything is applied
+	const auto numWords = static_cast<size_t> ((parameters.size() + 31) / 32);
+
+	if (changedParameters.size() != numWords)
+		changedParameters = std::vector<std::atomic<juce::uint32>> (numWords);
+
+	auto loaded = load (file, parameters);
+
+	pendingPreset.store (-1);
+	selectedPreset.store (-1);
+
+	retiredContents = std::move (contents);
+	contents		= std::move (loaded);
+
+	liveContents.store (contents.get(), std::memory_order_release);
+
+	// nothing can be applied from an empty library, so there's nothing to listen for
+	if (contents != nullptr)
+		startTimerHz (notificationsPerSecond);
+	else
+		stopTimer();
+
+	return contents != nullptr;
+}
+
+void PresetLibrary::openWhenNeeded (const juce::File& file, const Parameters& parametersToUse)
+{
+	parameters	 = parametersToUse;
+	libraryFile	 = file;
+	needsOpening = true;
+}
+
+void PresetLibrary::openIfNeeded()
+{
+	if (needsOpening)
+		open (libraryFile, parameters);
+}
+
+static float readFloat (const juce::uint8* data) noexcept
+{
+	const auto bits = juce::ByteOrder::littleEndianInt (data);
+
+	float value;
+	std::memcpy (&value, &bits, sizeof (value));
+	return value;
+}
+
+std::unique_ptr<PresetLibrary::Contents> PresetLibrary::load (const juce::File& file, const Parameters& parameters)
+{
+	if (! file.existsAsFile())
+		return {};
+
+	auto contents = std::make_unique<Contents>();
+
+	contents->mapping = std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readOnly);
+
+	const auto* data = static_cast<const juce::uint8*> (contents->mapping->getData());
+	const auto	size = static_cast<juce::uint64> (contents->mapping->getSize());
+
+	if (data == nullptr || size < headerBytes)
+		return {};
+
+	const auto readInt = [data] (juce::uint64 offset)
+	{ return juce::ByteOrder::littleEndianInt (data + offset); };
+
+	if (readInt (0) != magic || readInt (4) != version)
+		return {};
+
+	const auto numParameters = static_cast<juce::uint64> (readInt (8));
+	const auto numPresets	 = static_cast<juce::uint64> (readInt (12));
+
+	const auto idTable		= static_cast<juce::uint64> (headerBytes);
+	const auto nameTable	= idTable + 4 * numParameters;
+	const auto valuesStart	= nameTable + 4 * numPresets;
+	const auto stringsStart = valuesStart + 4 * numParameters * numPresets;
+
+	if (stringsStart > size)
+		return {};
+
+	const auto readString = [&] (juce::uint64 tableEntry, String& result)
+	{
+		const auto start = stringsStart + readInt (tableEntry);
+
+		if (start >= size)
+			return false;
+
+		const auto* text = reinterpret_cast<const char*> (data + start);
+		const auto* end	 = static_cast<const char*> (std::memchr (text, 0, static_cast<size_t> (size - start)));
+
+		if (end == nullptr)
+			return false;
+
+		result = String::fromUTF8 (text, static_cast<int> (end - text));
+		return true;
+	};
+
+	contents->parameterIDs.resize (static_cast<size_t> (numParameters));
+	contents->names.resize (static_cast<size_t> (numPresets));
+
+	for (juce::uint64 i = 0; i < numParameters; ++i)
+		if (! readString (idTable + 4 * i, contents->parameterIDs[static_cast<size_t> (i)]))
+			return {};
+
+	for (juce::uint64 i = 0; i < numPresets; ++i)
+		if (! readString (nameTable + 4 * i, contents->names[static_cast<size_t> (i)]))
+			return {};
+
+	contents->values = data + valuesStart;
+
+	// the library's parameters may not all exist any more, or be in the same order as the processor's
+	std::vector<juce::AudioProcessorParameter*> matches;
+
+	for (const auto& parameterID : contents->parameterIDs)
+	{
+		juce::AudioProcessorParameter* match = nullptr;
+
+		for (auto* parameter : parameters)
+		{
+			if (getParameterID (*parameter) == parameterID)
+			{
+				match = parameter;
+				break;
+			}
+		}
+
+		matches.push_back (match);
+	}
+
+	contents->sets.resize (static_cast<size_t> (numPresets));
+
+	for (size_t preset = 0; preset < contents->sets.size(); ++preset)
+	{
+		const auto* row = contents->values + 4 * numParameters * preset;
+
+		auto& values = contents->sets[preset].values;
+
+		for (size_t i = 0; i < matches.size(); ++i)
+		{
+			const auto value = readFloat (row + 4 * i);
+
+			if (matches[i] != nullptr && ! std::isnan (value))
+				values.emplace_back (matches[i], juce::jlimit (0.f, 1.f, value));
+		}
+	}
+
+	return contents;
+}
+
+bool PresetLibrary::addPreset (const String& name)
+{
+	jassert (libraryFile != juce::File());
+
+	openIfNeeded();
+
+	std::vector<Preset> presets;
+
+	if (contents != nullptr)
+	{
+		const auto numParameters = contents->parameterIDs.size();
+
+		for (size_t i = 0; i < contents->names.size(); ++i)
+		{
+			auto& preset = presets.emplace_back();
+
+			preset.name = contents->names[i];
+
+			const auto* row = contents->values + 4 * numParameters * i;
+
+			for (size_t p = 0; p < numParameters; ++p)
+				preset.values.emplace_back (contents->parameterIDs[p], readFloat (row + 4 * p));
+		}
+	}
+
+	auto& preset = presets.emplace_back();
+
+	preset.name = name;
+
+	// Windows won't replace a mapped file, and nothing else reads the mappings once they're loaded
+	for (auto* loaded : { contents.get(), retiredContents.get() })
+	{
+		if (loaded != nullptr)
+		{
+			loaded->mapping.reset();
+			loaded->values = nullptr;
+		}
+	}
+
+	for (const auto* parameter : parameters)
+		preset.values.emplace_back (getParameterID (*parameter), parameter->getValue());
+
+	if (! write (libraryFile, presets))
+		return false;
+
+	return open (libraryFile, parameters);
+}
+
+/* Presets may have been saved with different parameters, so the file lists every parameter that any
+   of its presets has, and each preset has NaN for the ones it doesn't.
+ */
+bool PresetLibrary::write (const juce::File& file, const std::vector<Preset>& presets)
+{
+	juce::StringArray parameterIDs;
+
+	for (const auto& preset : presets)
+		for (const auto& value : preset.values)
+			parameterIDs.addIfNotAlreadyThere (value.first);
+
+	juce::MemoryOutputStream strings;
+
+	const auto addString = [&strings] (const String& text)
+	{
+		const auto offset = static_cast<int> (strings.getPosition());
+		strings.writeString (text);
+		return offset;
+	};
+
+	juce::MemoryOutputStream out;
+
+	out.writeInt (static_cast<int> (magic));
+	out.writeInt (static_cast<int> (version));
+	out.writeInt (parameterIDs.size());
+	out.writeInt (static_cast<int> (presets.size()));
+
+	for (const auto& parameterID : parameterIDs)
+		out.writeInt (addString (parameterID));
+
+	for (const auto& preset : presets)
+		out.writeInt (addString (preset.name));
+
+	for (const auto& preset : presets)
+	{
+		std::vector<float> row (static_cast<size_t> (parameterIDs.size()), std::numeric_limits<float>::quiet_NaN());
+
+		for (const auto& [parameterID, value] : preset.values)
+			row[static_cast<size_t> (parameterIDs.indexOf (parameterID))] = value;
+
+		for (const auto value : row)
+			out.writeFloat (value);
+	}
+
+	out << strings.getMemoryBlock();
+
+	file.getParentDirectory().createDirectory();
+
+	juce::TemporaryFile temp { file };
+
+	if (! temp.getFile().replaceWithData (out.getData(), out.getDataSize()))
+		return false;
+
+	return temp.overwriteTargetFileWithTemporary();
+}
+
+int PresetLibrary::getNumPresets()
+{
+	openIfNeeded();
+
+	if (contents == nullptr)
+		return 0;
+
+	return static_cast<int> (contents->names.size());
+}
+
+String PresetLibrary::getPresetName (int index)
+{
+	openIfNeeded();
+
+	if (contents == nullptr || ! juce::isPositiveAndBelow (index, getNumPresets()))
+		return {};
+
+	return contents->names[static_cast<size_t> (index)];
+}
+
+void PresetLibrary::select (int index) noexcept
+{
+	selectedPreset.store (index);
+	pendingPreset.store (index, std::memory_order_release);
+}
+
+const PresetLibrary::ParameterSet* PresetLibrary::takeSelectedPreset() noexcept
+{
+	// cheap enough to check every block: this is only a load unless a preset has been selected
+	if (pendingPreset.load (std::memory_order_relaxed) < 0)
+		return nullptr;
+
+	const auto index = pendingPreset.exchange (-1, std::memory_order_acq_rel);
+
+	const auto* live = liveContents.load (std::memory_order_acquire);
+
+	if (live == nullptr || ! juce::isPositiveAndBelow (index, static_cast<int> (live->sets.size())))
+		return nullptr;
+
+	return &live->sets[static_cast<size_t> (index)];
+}
+
+void PresetLibrary::apply (const ParameterSet& set) noexcept
+{
+	for (const auto& [parameter, value] : set.values)
+	{
+		if (parameter->getValue() == value)
+			continue;
+
+		parameter->setValue (value);
+
+		const auto index = static_cast<size_t> (parameter->getParameterIndex());
+
+		changedParameters[index / 32].fetch_or (juce::uint32 (1) << (index % 32), std::memory_order_release);
+	}
+}
+
+void PresetLibrary::timerCallback()
+{
+	for (size_t word = 0; word < changedParameters.size(); ++word)
+	{
+		auto bits = changedParameters[word].exchange (0, std::memory_order_acquire);
+
+		for (auto bit = 0; bits != 0; ++bit, bits >>= 1)
+		{
+			if ((bits & 1) == 0)
+				continue;
+
+			auto* parameter = parameters[static_cast<int> (word * 32) + bit];
+
+			parameter->sendValueChangedMessageToListeners (parameter->getValue());
+		}
+	}
+}
+
+juce::File PresetLibrary::getDefaultFile()
+{
+	return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+		.getChildFile ("Imogen")
+		.getChildFile ("Presets.imogenpresets");
+}
+
+String PresetLibrary::getParameterID (const juce::AudioProcessorParameter& parameter)
+{
+	if (const auto* withID = dynamic_cast<const juce::AudioProcessorParameterWithID*> (&parameter))
+		return withID->paramID;
+
+	return parameter.getName (128);
+}
+
+}  // namespace Imogen
@@ -0,0 +1,126 @@
+#pragma once
+
+namespace Imogen
+{
+/* A library of presets kept in one binary file, which is memory-mapped when it's opened instead of
+   being parsed. Every preset's values are matched up with the processor's parameters up front, so
+   that switching presets is only a matter of handing one ready-made set of values to the audio
+   thread, which it applies at the start of its next block without locking or allocating. The host
+   and the parameters' listeners are told about the new values afterwards, from the message thread.
+
+   The file is little-endian throughout:
+   - a header: the magic number, the version, the number of parameters and of presets
+   - the offset of each parameter's ID in the string table
+   - the offset of each preset's name in the string table
+   - each preset's normalised value for every parameter, as floats, with NaN for ones it leaves alone
+   - the string table, of null-terminated UTF-8 strings
+ */
+class PresetLibrary : private juce::Timer
+{
+public:
+
+	using Parameters = juce::Array<juce::AudioProcessorParameter*>;
+
+	/* One preset's values, matched with the parameters they're for. */
+	struct ParameterSet
+	{
+		std::vector<std::pair<juce::AudioProcessorParameter*, float>> values;
+	};
+
+	struct Preset
+	{
+		String name;
+
+		std::vector<std::pair<String, float>> values;
+	};
+
+	/* Maps the file and matches its presets to these parameters. Returns false if the file doesn't
+	   exist or isn't a valid library, in which case the library is empty.
+	   Only call this from the message thread.
+	 */
+	bool open (const juce::File& file, const Parameters& parameters);
+
+	/* Remembers the file and parameters, but only opens the library the first time its presets are
+	   listed or added to, so that creating a plugin doesn't read the file.
+	   Only call this from the message thread.
+	 */
+	void openWhenNeeded (const juce::File& file, const Parameters& parameters);
+
+	/* Adds a preset of the parameters' current values to the library's file and opens it again.
+	   Only call this from the message thread.
+	 */
+	bool addPreset (const String& name);
+
+	/* Only call these from the message thread. */
+	int	   getNumPresets();
+	String getPresetName (int index);
+
+	/* Asks the audio thread to switch to a preset at the start of its next block. Any thread may call this. */
+	void select (int index) noexcept;
+
+	/* The preset last selected, or -1 if none has been. */
+	int getSelectedPreset() const noexcept { return selectedPreset.load(); }
+
+	/* Returns the preset selected since the last call, if there is one. Only call this from the audio thread. */
+	const ParameterSet* takeSelectedPreset() noexcept;
+
+	/* Stores a set's values into the parameters without notifying anything, since that could lock or
+	   allocate, and leaves the host and the parameters' listeners to be told on the message thread.
+	   Only call this from the audio thread.
+	 */
+	void apply (const ParameterSet& set) noexcept;
+
+	static bool write (const juce::File& file, const std::vector<Preset>& presets);
+
+	/* The user's library, which is opened the first time the plugin's presets are used. */
+	static juce::File getDefaultFile();
+
+	static String getParameterID (const juce::AudioProcessorParameter& parameter);
+
+private:
+
+	struct Contents
+	{
+		std::unique_ptr<juce::MemoryMappedFile> mapping;
+
+		std::vector<String> parameterIDs;
+		std::vector<String> names;
+
+		// the raw values of every preset, one row per preset, in the mapped file until it's unmapped
+		const juce::uint8* values { nullptr };
+
+		std::vector<ParameterSet> sets;
+	};
+
+	static std::unique_ptr<Contents> load (const juce::File& file, const Parameters& parameters);
+
+	void openIfNeeded();
+
+	/* Notifies the host and listeners of every parameter the audio thread has changed since the last call. */
+	void timerCallback() final;
+
+	Parameters parameters;
+	juce::File libraryFile;
+	bool	   needsOpening { false };
+
+	/* The audio thread may still be applying a set from the contents replaced by the last call to
+	   open(), so those are only freed by the call after that.
+	 */
+	std::unique_ptr<Contents> contents, retiredContents;
+	std::atomic<Contents*>	  liveContents { nullptr };
+
+	std::atomic<int> pendingPreset { -1 }, selectedPreset { -1 };
+
+	// one bit per parameter, by its index, set by apply() and cleared once it has been announced, so
+	// that a parameter only the first of two quickly applied presets changed is still announced
+	std::vector<std::atomic<juce::uint32>> changedParameters;
+
+	static constexpr auto notificationsPerSecond = 20;
+
+	static constexpr auto magic	  = static_cast<juce::uint32> (0x4c504d49);  // "IMPL"
+	static constexpr auto version = static_cast<juce::uint32> (1);
+
+	static constexpr auto headerBytes = 16;
+};
+
+}  // namespace Imogen
@@ -0,0 +1,169 @@
+
+namespace Imogen
+{
+StageTimings::StageTimings()
+	: nanosPerTick (1.0e9 / static_cast<double> (juce::Time::getHighResolutionTicksPerSecond()))
+{
+	for (auto& histogram : histograms)
+		histogram.clear();
+}
+
+void StageTimings::record (EngineStage stage, juce::int64 elapsedTicks) noexcept
+{
+	auto& histogram = histograms[static_cast<size_t> (stage)];
+
+	const auto resets = requestedResets.load (std::memory_order_relaxed);
+
+	if (histogram.appliedResets != resets)
+	{
+		histogram.clear();
+		histogram.appliedResets = resets;
+	}
+
+	histogram.add (static_cast<juce::uint64> (std::max (juce::int64 (0), elapsedTicks) * nanosPerTick));
+}
+
+void StageTimings::flush() noexcept
+{
+	for (size_t i = 0; i < numStages; ++i)
+	{
+		if (! hasPending[i])
+			continue;
+
+		record (static_cast<EngineStage> (i), pendingTicks[i]);
+
+		pendingTicks[i] = 0;
+		hasPending[i]	= false;
+	}
+}
+
+StageTimings::Snapshot StageTimings::getSnapshot() const
+{
+	Snapshot snapshot;
+
+	for (size_t i = 0; i < numStages; ++i)
+		snapshot[i] = histograms[i].summarise();
+
+	return snapshot;
+}
+
+void StageTimings::reset() noexcept
+{
+	requestedResets.fetch_add (1, std::memory_order_relaxed);
+}
+
+String StageTimings::getStageName (EngineStage stage)
+{
+	switch (stage)
+	{
+		case (EngineStage::preHarmonyEffects) : return TRANS ("Pre-harmony effects");
+		case (EngineStage::analysis) : return TRANS ("Analysis");
+		case (EngineStage::harmonizer) : return TRANS ("Harmonizer");
+		case (EngineStage::leadProcessor) : return TRANS ("Lead processor");
+		case (EngineStage::postHarmonyEffects) : return TRANS ("Post-harmony effects");
+		default : return {};
+	}
+}
+
+/*------------------------------------------------------------------------------------------*/
+
+// the audio thread is the only writer, so plain loads and stores are enough here
+
+void StageTimings::Histogram::add (juce::uint64 nanos) noexcept
+{
+	constexpr auto relaxed = std::memory_order_relaxed;
+
+	auto& bin = bins[static_cast<size_t> (getBin (nanos))];
+	bin.store (bin.load (relaxed) + 1, relaxed);
+
+	const auto prevCount = count.load (relaxed);
+
+	if (prevCount == 0 || nanos < minNanos.load (relaxed))
+		minNanos.store (nanos, relaxed);
+
+	if (nanos > maxNanos.load (relaxed))
+		maxNanos.store (nanos, relaxed);
+
+	totalNanos.store (totalNanos.load (relaxed) + nanos, relaxed);
+
+	count.store (prevCount + 1, std::memory_order_release);
+}
+
+void StageTimings::Histogram::clear() noexcept
+{
+	for (auto& bin : bins)
+		bin.store (0, std::memory_order_relaxed);
+
+	minNanos.store (0, std::memory_order_relaxed);
+	maxNanos.store (0, std::memory_order_relaxed);
+	totalNanos.store (0, std::memory_order_relaxed);
+	count.store (0, std::memory_order_release);
+}
+
+StageTimings::Summary StageTimings::Histogram::summarise() const
+{
+	Summary summary;
+
+	const auto total = count.load (std::memory_order_acquire);
+
+	if (total == 0)
+		return summary;
+
+	constexpr auto toMicros = 0.001;
+
+	summary.numBlocks  = total;
+	summary.minMicros  = static_cast<double> (minNanos.load (std::memory_order_relaxed)) * toMicros;
+	summary.maxMicros  = static_cast<double> (maxNanos.load (std::memory_order_relaxed)) * toMicros;
+	summary.meanMicros = static_cast<double> (totalNanos.load (std::memory_order_relaxed)) / static_cast<double> (total) * toMicros;
+	summary.p99Micros  = juce::jmin (getPercentileNanos (total, 0.99) * toMicros, summary.maxMicros);
+	summary.p999Micros = juce::jmin (getPercentileNanos (total, 0.999) * toMicros, summary.maxMicros);
+
+	return summary;
+}
+
+double StageTimings::Histogram::getPercentileNanos (juce::int64 total, double percentile) const
+{
+	const auto target = static_cast<juce::int64> (std::ceil (static_cast<double> (total) * percentile));
+
+	juce::int64 seen = 0;
+
+	for (auto i = 0; i < numBins; ++i)
+	{
+		seen += bins[static_cast<size_t> (i)].load (std::memory_order_relaxed);
+
+		if (seen >= target)
+			return getBinCentreNanos (i);
+	}
+
+	return getBinCentreNanos (numBins - 1);
+}
+
+int StageTimings::Histogram::getBin (juce::uint64 nanos) noexcept
+{
+	if (nanos < binsPerOctave)
+		return static_cast<int> (nanos);
+
+	auto octave = 0;
+
+	for (auto v = nanos; v > 1; v >>= 1)
+		++octave;
+
+	const auto mantissa = static_cast<int> ((nanos >> (octave - 3)) & (binsPerOctave - 1));
+
+	return std::min ((octave - 2) * binsPerOctave + mantissa, numBins - 1);
+}
+
+double StageTimings::Histogram::getBinCentreNanos (int bin) noexcept
+{
+	if (bin < binsPerOctave)
+		return static_cast<double> (bin);
+
+	const auto octave	= bin / binsPerOctave + 2;
+	const auto mantissa = bin % binsPerOctave;
+
+	const auto width = std::ldexp (1.0, octave - 3);
+
+	return (binsPerOctave + mantissa + 0.5) * width;
+}
+
+}  // namespace Imogen
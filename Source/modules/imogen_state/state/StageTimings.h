@@ -0,0 +1,121 @@
+#pragma once
+
+#ifndef IMOGEN_STAGE_TIMINGS
+#	define IMOGEN_STAGE_TIMINGS 1
+#endif
+
+namespace Imogen
+{
+enum class EngineStage
+{
+	preHarmonyEffects,
+	analysis,
+	harmonizer,
+	leadProcessor,
+	postHarmonyEffects,
+	numStages
+};
+
+
+/* Per-stage CPU time histograms for the engine's render callback.
+   Only the audio thread records; any thread may take a snapshot without locking.
+ */
+class StageTimings
+{
+public:
+
+	static constexpr auto numStages = static_cast<size_t> (EngineStage::numStages);
+
+	struct Summary
+	{
+		juce::int64 numBlocks { 0 };
+
+		double minMicros { 0. }, meanMicros { 0. }, p99Micros { 0. }, p999Micros { 0. }, maxMicros { 0. };
+	};
+
+	using Snapshot = std::array<Summary, numStages>;
+
+	StageTimings();
+
+	template <typename Callback>
+	void time (EngineStage stage, Callback&& callback)
+	{
+#if IMOGEN_STAGE_TIMINGS
+		const auto start = juce::Time::getHighResolutionTicks();
+		callback();
+		record (stage, juce::Time::getHighResolutionTicks() - start);
+#else
+		juce::ignoreUnused (stage);
+		callback();
+#endif
+	}
+
+	/* Like time(), but for stages that run several times per block: the time is added to a running
+	   total for the stage, which is recorded as one measurement by the next call to flush().
+	 */
+	template <typename Callback>
+	void accumulate (EngineStage stage, Callback&& callback)
+	{
+#if IMOGEN_STAGE_TIMINGS
+		const auto start = juce::Time::getHighResolutionTicks();
+		callback();
+
+		const auto index = static_cast<size_t> (stage);
+
+		pendingTicks[index] += juce::Time::getHighResolutionTicks() - start;
+		hasPending[index] = true;
+#else
+		juce::ignoreUnused (stage);
+		callback();
+#endif
+	}
+
+	void flush() noexcept;
+
+	void record (EngineStage stage, juce::int64 elapsedTicks) noexcept;
+
+	Snapshot getSnapshot() const;
+
+	/* Clears all histograms. The audio thread applies the reset the next time it records. */
+	void reset() noexcept;
+
+	static String getStageName (EngineStage stage);
+
+private:
+
+	struct Histogram
+	{
+		void add (juce::uint64 nanos) noexcept;
+		void clear() noexcept;
+
+		Summary summarise() const;
+
+		// 8 bins per octave up to ~18 minutes; the first 8 bins are exact
+		static constexpr auto binsPerOctave = 8;
+		static constexpr auto numBins		= binsPerOctave * 38;
+
+		static int getBin (juce::uint64 nanos) noexcept;
+		static double getBinCentreNanos (int bin) noexcept;
+
+		double getPercentileNanos (juce::int64 total, double percentile) const;
+
+		std::array<std::atomic<juce::uint32>, numBins> bins;
+
+		std::atomic<juce::int64>  count { 0 };
+		std::atomic<juce::uint64> totalNanos { 0 }, minNanos { 0 }, maxNanos { 0 };
+
+		int appliedResets { 0 };
+	};
+
+	std::array<Histogram, numStages> histograms;
+
+	std::atomic<int> requestedResets { 0 };
+
+	// only touched by the audio thread
+	std::array<juce::int64, numStages> pendingTicks {};
+	std::array<bool, numStages>		   hasPending {};
+
+	const double nanosPerTick;
+};
+
+}  // namespace Imogen
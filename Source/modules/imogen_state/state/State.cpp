@@ -1,31 +1,92 @@
 
 namespace Imogen
 {
-void CustomStateData::serialize (TreeReflector&)
+void CustomStateData::serialize (TreeReflector& ref)
 {
+	const juce::ScopedLock sl (lock);
+
+	// this runs for saving as well as loading, so only a path that was actually loaded bumps the version
+	const auto previousPath = impulseResponsePath;
+
+	ref.add ("ImpulseResponse", impulseResponsePath);
+
+	if (impulseResponsePath != previousPath)
+		++impulseResponseVersion;
+}
+
+void CustomStateData::setImpulseResponse (const juce::File& file)
+{
+	const juce::ScopedLock sl (lock);
+
+	const auto path = file.getFullPathName();
+
+	if (impulseResponsePath == path)
+		return;
+
+	impulseResponsePath = path;
+
+	++impulseResponseVersion;
+}
+
+String CustomStateData::getImpulseResponsePath() const
+{
+	const juce::ScopedLock sl (lock);
+
+	return impulseResponsePath;
+}
+
+void CustomStateData::setImpulseResponsePath (juce::CharPointer_UTF8 path)
+{
+	const juce::ScopedLock sl (lock);
+
+	if (impulseResponsePath == path)
+		return;
+
+	impulseResponsePath = String (path);
+
+	++impulseResponseVersion;
+}
+
+juce::File CustomStateData::getImpulseResponse() const
+{
+	const juce::ScopedLock sl (lock);
+
+	if (impulseResponsePath.isEmpty())
+		return {};
+
+	return juce::File { impulseResponsePath };
 }
 
 State::State() : plugin::CustomState<Parameters, CustomStateData> ("Imogen")
 {
 	internals.addToList (getParameters());
-	meters.addToList (getParameters());
 }
 
 Parameters::Parameters()
 	: ParameterList ("ImogenParameters")
 {
-	add (inputMode, dryWet, inputGain, outputGain, leadBypass, harmonyBypass, stereoWidth, lowestPanned, leadPan, noiseGateToggle, noiseGateThresh, deEsserToggle, deEsserThresh, deEsserAmount, compToggle, compAmount, delayToggle, delayDryWet, limiterToggle);
-}
+	add (inputMode, dryWet, inputGain, outputGain, leadBypass, harmonyBypass, stereoWidth, lowestPanned, leadPan, noiseGateToggle, noiseGateThresh, deEsserToggle, deEsserThresh, deEsserAmount, compToggle, compAmount, delayState.delayToggle, delayState.delayDryWet, limiterToggle);
 
+	// parameters added since go at the end, so that hosts still find the older ones at the same indices
+	add (reverbState.reverbConvolution, delayState.delaySync, delayState.delayTime, delayState.delayDivision, delayState.delayFeedback, delayState.delayTaps, delayState.delayModDepth, delayState.delayModRate, limiterCeiling, limiterRelease, midiState.pitchToMidi, noiseGateRelease);
+
+	deEsserChanges.add (deEsserToggle, deEsserThresh, deEsserAmount);
+	compChanges.add (compToggle, compAmount);
+	limiterChanges.add (limiterToggle, limiterCeiling, limiterRelease);
+
+	midiState.changes.add (lowestPanned);
+}
 
-void Meters::addToList (plugin::ParameterList& list)
+void Parameters::markAllChanged() noexcept
 {
-	list.add (inputLevel, outputLevelL, outputLevelR, gateRedux, compRedux, deEssRedux, limRedux, reverbLevel, delayLevel);
+	for (auto* group : { &deEsserChanges, &compChanges, &limiterChanges, &eqState.changes, &reverbState.changes, &delayState.changes, &midiState.changes })
+		group->markChanged();
 }
 
+
 void Internals::addToList (plugin::ParameterList& list)
 {
-	list.addInternal (abletonLinkEnabled, abletonLinkSessionPeers, mtsEspIsConnected, lastMovedMidiController, lastMovedCCValue, guiDarkMode, currentInputNote, currentCentsSharp);
+	list.addInternal (abletonLinkEnabled, abletonLinkSessionPeers, mtsEspIsConnected, lastMovedMidiController, lastMovedCCValue, guiDarkMode, numVoices, voiceRenderThreads, lowLatencyMode, lowLatencyPitchFloor);
 	// mtsEspScaleName
 }
 
@@ -33,12 +94,36 @@ void Internals::addToList (plugin::ParameterList& list)
 EQState::EQState (plugin::ParameterList& list)
 {
 	list.add (eqToggle, eqLowShelfFreq, eqLowShelfQ, eqLowShelfGain, eqHighShelfFreq, eqHighShelfQ, eqHighShelfGain, eqHighPassFreq, eqHighPassQ, eqPeakFreq, eqPeakQ, eqPeakGain);
+
+	changes.add (eqToggle, eqLowShelfFreq, eqLowShelfQ, eqLowShelfGain, eqHighShelfFreq, eqHighShelfQ, eqHighShelfGain, eqHighPassFreq, eqHighPassQ, eqPeakFreq, eqPeakQ, eqPeakGain);
 }
 
 
 ReverbState::ReverbState (plugin::ParameterList& list)
 {
 	list.add (reverbToggle, reverbDryWet, reverbDecay, reverbDuck, reverbLoCut, reverbHiCut);
+
+	changes.add (reverbToggle, reverbConvolution, reverbDryWet, reverbDecay, reverbDuck, reverbLoCut, reverbHiCut);
+}
+
+
+DelayState::DelayState()
+{
+	changes.add (delayToggle, delayDryWet, delaySync, delayTime, delayDivision, delayFeedback, delayTaps, delayModDepth, delayModRate);
+}
+
+double DelayState::getDivisionInBeats (int division)
+{
+	constexpr std::array<double, numDivisions> beats { 0.125, 1. / 6., 0.25, 0.375, 1. / 3., 0.5, 0.75, 2. / 3., 1., 1.5, 2., 3. };
+
+	return beats[static_cast<size_t> (juce::jlimit (1, numDivisions, division) - 1)];
+}
+
+String DelayState::getDivisionName (int division)
+{
+	constexpr std::array<const char*, numDivisions> names { "1/32", "1/16T", "1/16", "1/16D", "1/8T", "1/8", "1/8D", "1/4T", "1/4", "1/4D", "1/2", "1/2D" };
+
+	return names[static_cast<size_t> (juce::jlimit (1, numDivisions, division) - 1)];
 }
 
 
@@ -46,6 +131,8 @@ MidiState::MidiState (plugin::ParameterList& list)
 {
 	list.add (pitchbendRange, velocitySens, aftertouchToggle, voiceStealing, midiLatch, pitchGlide, glideTime, adsrAttack, adsrDecay, adsrSustain, adsrRelease, pedalToggle, pedalThresh, descantToggle, descantThresh, descantInterval);
 
+	changes.add (pitchbendRange, velocitySens, aftertouchToggle, voiceStealing, midiLatch, pitchGlide, glideTime, adsrAttack, adsrDecay, adsrSustain, adsrRelease, pedalToggle, pedalThresh, pedalInterval, descantToggle, descantThresh, descantInterval);
+
 	list.setPitchbendParameter (editorPitchbend);
 }
 
@@ -1,17 +1,36 @@
 #pragma once
 
 #include "Parameters.h"
-#include "Meters.h"
+#include "Telemetry.h"
 #include "Internals.h"
+#include "StageTimings.h"
+#include "LatencyBudget.h"
+#include "MidiInputQueue.h"
+#include "PresetLibrary.h"
 
 
 namespace Imogen
 {
 struct CustomStateData : SerializableData
 {
+	/* The impulse response for the convolution reverb. Any thread may get or set it; the version
+	   changes whenever the path does, so that the engine can poll for a new file cheaply.
+	 */
+	void	   setImpulseResponse (const juce::File& file);
+	juce::File getImpulseResponse() const;
+	int		   getImpulseResponseVersion() const noexcept { return impulseResponseVersion.load(); }
+
+	/* The path as it's stored, which is cheaper to copy than making a File of it. */
+	String getImpulseResponsePath() const;
+	void   setImpulseResponsePath (juce::CharPointer_UTF8 path);
+
 private:
 
 	void serialize (TreeReflector& ref) final;
+
+	juce::CriticalSection lock;
+	String				  impulseResponsePath;
+	std::atomic<int>	  impulseResponseVersion { 0 };
 };
 
 
@@ -19,8 +38,21 @@ struct State : plugin::CustomState<Parameters, CustomStateData>
 {
 	State();
 
-	Internals internals;
-	Meters	  meters;
+	Internals	  internals;
+	StageTimings  timings;
+	LatencyBudget latency;
+
+	/* The meters and the detected pitch, which the engine only measures while the editor is subscribed. */
+	Telemetry telemetry;
+
+	/* Notes played from the GUI or the remote app, which the engine adds to the host's MIDI. */
+	MidiInputQueue midiInput;
+
+	/* The user's library, opened the first time the editor lists it; the engine applies selected presets. */
+	PresetLibrary presets;
+
+	/* The host's tempo, updated by the processor at the start of every block that has one. */
+	std::atomic<double> tempo { 120. };
 };
 
 }  // namespace Imogen
@@ -0,0 +1,167 @@
+
+namespace Imogen
+{
+StateChunk::StateChunk (State& stateToUse, const juce::Array<juce::AudioProcessorParameter*>& parametersToUse)
+	: state (stateToUse)
+{
+	for (auto* parameter : parametersToUse)
+		parameters.emplace_back (hashParameterID (PresetLibrary::getParameterID (*parameter)), parameter);
+
+	std::sort (parameters.begin(), parameters.end(), [] (const auto& a, const auto& b)
+			   { return a.first < b.first; });
+
+	// two IDs with the same hash would restore each other's values
+	jassert (std::adjacent_find (parameters.begin(), parameters.end(), [] (const auto& a, const auto& b)
+								 { return a.first == b.first; })
+			 == parameters.end());
+
+	buffer.setSize (headerBytes + parameters.size() * 8 + numInternalSettings * 4 + 4 + initialPathBytes);
+}
+
+/* FNV-1a, which is plenty to tell a hundred or so IDs apart. */
+juce::uint32 StateChunk::hashParameterID (const String& parameterID) noexcept
+{
+	auto hash = static_cast<juce::uint32> (2166136261u);
+
+	for (auto* c = parameterID.toRawUTF8(); *c != 0; ++c)
+	{
+		hash ^= static_cast<juce::uint8> (*c);
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+StateChunk::InternalSettings StateChunk::getInternalSettings() const
+{
+	auto& internals = state.internals;
+
+	return { internals.guiDarkMode->get() ? 1 : 0,
+			 internals.numVoices->get(),
+			 internals.voiceRenderThreads->get(),
+			 internals.lowLatencyMode->get() ? 1 : 0,
+			 internals.lowLatencyPitchFloor->get() };
+}
+
+template <typename Param, typename Value>
+static void setIfChanged (Param& param, Value value)
+{
+	if (param->get() != value)
+		param->set (value);
+}
+
+size_t StateChunk::write()
+{
+	const auto path		 = state.customData.getImpulseResponsePath();
+	const auto pathBytes = path.getNumBytesAsUTF8() + 1;
+
+	const auto size = headerBytes + parameters.size() * 8 + numInternalSettings * 4 + 4 + pathBytes;
+
+	if (size > buffer.getSize())
+		buffer.setSize (size);
+
+	juce::MemoryOutputStream out { buffer.getData(), buffer.getSize() };
+
+	out.writeInt (static_cast<int> (magic));
+	out.writeInt (static_cast<int> (version));
+	out.writeInt (static_cast<int> (parameters.size()));
+	out.writeInt (numInternalSettings);
+
+	for (const auto& [hash, parameter] : parameters)
+	{
+		out.writeInt (static_cast<int> (hash));
+		out.writeFloat (parameter->getValue());
+	}
+
+	for (const auto setting : getInternalSettings())
+		out.writeInt (setting);
+
+	out.writeInt (static_cast<int> (pathBytes));
+	out.write (path.toRawUTF8(), pathBytes);
+
+	jassert (out.getPosition() == static_cast<juce::int64> (size));
+
+	return size;
+}
+
+bool StateChunk::isStateChunk (const void* data, size_t size) noexcept
+{
+	return data != nullptr && size >= headerBytes && juce::ByteOrder::littleEndianInt (data) == magic;
+}
+
+juce::AudioProcessorParameter* StateChunk::findParameter (juce::uint32 hash) const noexcept
+{
+	const auto match = std::lower_bound (parameters.begin(), parameters.end(), hash, [] (const auto& entry, juce::uint32 h)
+										 { return entry.first < h; });
+
+	if (match == parameters.end() || match->first != hash)
+		return nullptr;
+
+	return match->second;
+}
+
+bool StateChunk::restore (const void* data, size_t size)
+{
+	if (! isStateChunk (data, size))
+		return false;
+
+	const auto* bytes = static_cast<const juce::uint8*> (data);
+
+	const auto readInt = [bytes] (size_t offset)
+	{ return juce::ByteOrder::littleEndianInt (bytes + offset); };
+
+	if (readInt (4) > version)
+		return false;
+
+	const auto numParameters = static_cast<size_t> (readInt (8));
+	const auto numInternals	 = static_cast<size_t> (readInt (12));
+
+	const auto internalsStart = headerBytes + numParameters * 8;
+	const auto pathStart	  = internalsStart + numInternals * 4;
+
+	if (pathStart + 4 > size)
+		return false;
+
+	for (size_t i = 0; i < numParameters; ++i)
+	{
+		const auto offset = headerBytes + i * 8;
+
+		auto* parameter = findParameter (readInt (offset));
+
+		if (parameter == nullptr)
+			continue;
+
+		const auto bits = readInt (offset + 4);
+
+		float value;
+		std::memcpy (&value, &bits, sizeof (value));
+
+		if (parameter->getValue() != value)
+			parameter->setValueNotifyingHost (juce::jlimit (0.f, 1.f, value));
+	}
+
+	// settings added in later versions keep their current values if the chunk doesn't have them
+	auto settings = getInternalSettings();
+
+	for (size_t i = 0; i < std::min (numInternals, settings.size()); ++i)
+		settings[i] = static_cast<int> (readInt (internalsStart + i * 4));
+
+	auto& internals = state.internals;
+
+	setIfChanged (internals.guiDarkMode, settings[0] != 0);
+	setIfChanged (internals.numVoices, settings[1]);
+	setIfChanged (internals.voiceRenderThreads, settings[2]);
+	setIfChanged (internals.lowLatencyMode, settings[3] != 0);
+	setIfChanged (internals.lowLatencyPitchFloor, settings[4]);
+
+	const auto pathBytes = static_cast<size_t> (readInt (pathStart));
+
+	if (pathBytes == 0 || pathStart + 4 + pathBytes > size || bytes[pathStart + 4 + pathBytes - 1] != 0)
+		return true;
+
+	state.customData.setImpulseResponsePath (juce::CharPointer_UTF8 { reinterpret_cast<const char*> (bytes + pathStart + 4) });
+
+	return true;
+}
+
+}  // namespace Imogen
@@ -0,0 +1,71 @@
+#pragma once
+
+namespace Imogen
+{
+/* A compact, versioned binary form of the plugin's state, for hosts to save with their sessions.
+
+   The parameters are matched by a hash of their IDs, worked out once when the chunk is created,
+   so an older chunk still restores whatever parameters it shares with this build. The settings
+   in the internals follow in a fixed order, then the custom data.
+
+   Writing goes into a buffer allocated up front, and restoring only sets the values that changed,
+   so neither allocates unless the impulse response's path is longer than any seen before, or
+   has changed. Both are called by the host on the message thread, never the audio thread.
+
+   The layout, all little-endian:
+   - the magic number, the version, the number of parameters and the number of internal settings
+   - each parameter's ID hash and normalised value
+   - each internal setting, as an int
+   - the length of the impulse response's path in bytes, then its null-terminated UTF-8
+ */
+class StateChunk
+{
+public:
+
+	StateChunk (State& stateToUse, const juce::Array<juce::AudioProcessorParameter*>& parameters);
+
+	/* Writes the state to the chunk's own buffer, and returns the number of bytes written. */
+	size_t write();
+
+	const void* getData() const noexcept { return buffer.getData(); }
+
+	/* Host parameters are set with setValueNotifyingHost, so that the host and the editor hear about
+	   each one that changed; the audio thread picks the new values up at its next block.
+	   Returns false if the data isn't a state chunk, or is from a newer version.
+	 */
+	bool restore (const void* data, size_t size);
+
+	/* True if the data starts the way a state chunk does, so that other formats can be told apart. */
+	static bool isStateChunk (const void* data, size_t size) noexcept;
+
+private:
+
+	static juce::uint32 hashParameterID (const String& parameterID) noexcept;
+
+	juce::AudioProcessorParameter* findParameter (juce::uint32 hash) const noexcept;
+
+	// the user's settings among the internals, in the order they're stored; the rest only report
+	// what the engine is doing
+	static constexpr auto numInternalSettings = 5;
+
+	using InternalSettings = std::array<int, numInternalSettings>;
+
+	InternalSettings getInternalSettings() const;
+
+	State& state;
+
+	// sorted by hash, for looking up each parameter in a chunk being restored
+	std::vector<std::pair<juce::uint32, juce::AudioProcessorParameter*>> parameters;
+
+	juce::MemoryBlock buffer;
+
+	static constexpr auto magic	  = static_cast<juce::uint32> (0x53474d49);  // "IMGS"
+	static constexpr auto version = static_cast<juce::uint32> (1);
+
+	static constexpr auto headerBytes = 16;
+
+	// room for the impulse response's path before the buffer has to grow
+	static constexpr auto initialPathBytes = 1024;
+};
+
+}  // namespace Imogen
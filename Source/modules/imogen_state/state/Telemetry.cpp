@@ -0,0 +1,175 @@
+
+namespace Imogen
+{
+void TelemetryRecord::clear() noexcept
+{
+	peak.fill (0.f);
+	rms.fill (0.f);
+	gainReduction.fill (0.f);
+	effectLevel.fill (floorDecibels);
+
+	pitch	   = 0.f;
+	numSamples = 0;
+}
+
+void TelemetryRecord::merge (const TelemetryRecord& later) noexcept
+{
+	const auto totalSamples = numSamples + later.numSamples;
+
+	if (totalSamples <= 0)
+		return;
+
+	const auto weight	   = static_cast<float> (numSamples) / static_cast<float> (totalSamples);
+	const auto laterWeight = 1.f - weight;
+
+	for (auto level = 0; level < numLevels; ++level)
+	{
+		const auto i = static_cast<size_t> (level);
+
+		peak[i] = std::max (peak[i], later.peak[i]);
+		rms[i]	= std::sqrt (rms[i] * rms[i] * weight + later.rms[i] * later.rms[i] * laterWeight);
+	}
+
+	for (size_t i = 0; i < gainReduction.size(); ++i)
+		gainReduction[i] = std::max (gainReduction[i], later.gainReduction[i]);
+
+	for (size_t i = 0; i < effectLevel.size(); ++i)
+		effectLevel[i] = std::max (effectLevel[i], later.effectLevel[i]);
+
+	pitch	   = later.pitch;
+	numSamples = totalSamples;
+}
+
+/*------------------------------------------------------------------------------------------*/
+
+Telemetry::Listener::Listener (Telemetry& telemetryToUse, Callback&& callbackToUse)
+	: telemetry (telemetryToUse), callback (std::move (callbackToUse))
+{
+	JUCE_ASSERT_MESSAGE_THREAD
+
+	auto& listeners = telemetry.listeners;
+
+	listeners.push_back (this);
+
+	if (listeners.size() > 1)
+		return;
+
+	// anything left from an earlier subscription is stale by now
+	TelemetryRecord stale;
+
+	while (telemetry.pop (stale))
+		;
+
+	telemetry.subscribe();
+	telemetry.startTimerHz (updatesPerSecond);
+}
+
+Telemetry::Listener::~Listener()
+{
+	JUCE_ASSERT_MESSAGE_THREAD
+
+	auto& listeners = telemetry.listeners;
+
+	listeners.erase (std::remove (listeners.begin(), listeners.end(), this), listeners.end());
+
+	if (! listeners.empty())
+		return;
+
+	telemetry.stopTimer();
+	telemetry.unsubscribe();
+}
+
+Telemetry::~Telemetry()
+{
+	jassert (listeners.empty());
+
+	stopTimer();
+}
+
+void Telemetry::subscribe() noexcept
+{
+	numSubscribers.fetch_add (1, std::memory_order_relaxed);
+}
+
+void Telemetry::unsubscribe() noexcept
+{
+	numSubscribers.fetch_sub (1, std::memory_order_relaxed);
+}
+
+bool Telemetry::pop (TelemetryRecord& record) noexcept
+{
+	const auto position = readPosition.load (std::memory_order_relaxed);
+
+	if (position == writePosition.load (std::memory_order_acquire))
+		return false;
+
+	record = records[position & mask];
+
+	readPosition.store (position + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool Telemetry::beginBlock (int numSamples) noexcept
+{
+	active = numSubscribers.load (std::memory_order_relaxed) > 0;
+
+	if (active)
+	{
+		current.clear();
+		current.numSamples = numSamples;
+	}
+
+	return active;
+}
+
+void Telemetry::reportGainReduction (TelemetryRecord::GainReduction stage, float decibels) noexcept
+{
+	if (! active)
+		return;
+
+	auto& reduction = current.gainReduction[static_cast<size_t> (stage)];
+
+	reduction = std::max (reduction, decibels);
+}
+
+void Telemetry::reportEffectLevel (TelemetryRecord::Effect effect, float decibels) noexcept
+{
+	if (! active)
+		return;
+
+	auto& level = current.effectLevel[static_cast<size_t> (effect)];
+
+	level = std::max (level, decibels);
+}
+
+void Telemetry::publish() noexcept
+{
+	if (! active)
+		return;
+
+	const auto position = writePosition.load (std::memory_order_relaxed);
+
+	if (position - readPosition.load (std::memory_order_acquire) >= static_cast<juce::uint32> (capacity))
+		return;
+
+	records[position & mask] = current;
+
+	writePosition.store (position + 1, std::memory_order_release);
+}
+
+void Telemetry::timerCallback()
+{
+	TelemetryRecord merged, next;
+
+	if (! pop (merged))
+		return;
+
+	while (pop (next))
+		merged.merge (next);
+
+	for (auto* listener : listeners)
+		listener->callback (merged);
+}
+
+}  // namespace Imogen
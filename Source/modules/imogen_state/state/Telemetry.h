@@ -0,0 +1,135 @@
+#pragma once
+
+namespace Imogen
+{
+/* What the engine measured over one block, for the meters and the pitch display. */
+struct TelemetryRecord
+{
+	enum Level
+	{
+		input,
+		outputLeft,
+		outputRight,
+		numLevels
+	};
+
+	enum GainReduction
+	{
+		noiseGate,
+		compressor,
+		deEsser,
+		limiter,
+		numGainReductions
+	};
+
+	enum Effect
+	{
+		reverb,
+		delay,
+		numEffects
+	};
+
+	void clear() noexcept;
+
+	/* Folds a later record into this one: peaks and gain reductions are the highest of the two,
+	   levels are averaged over both blocks' samples, and the pitch is the later one's.
+	 */
+	void merge (const TelemetryRecord& later) noexcept;
+
+	// linear gain
+	std::array<float, numLevels> peak, rms;
+
+	// decibels, with effects that are off or silent at the floor
+	std::array<float, numGainReductions> gainReduction;
+	std::array<float, numEffects>		 effectLevel;
+
+	// the lead's pitch at the end of the block, in Hz, or 0 if it's unpitched
+	float pitch;
+
+	int numSamples;
+
+	static constexpr auto floorDecibels = -60.f;
+};
+
+
+/* Carries the meters and the detected pitch from the audio thread to the editor, without going
+   through the host's parameters. The engine fills in one record per block, which is pushed into a
+   single-producer, single-consumer ring, and all of it is skipped while nothing is subscribed.
+
+   On the message thread, listeners are given everything received since the last update, merged
+   into one record, at the meters' frame rate. A consumer that doesn't use listeners, such as a
+   test, can subscribe and pop the records itself instead, but only one thread may ever pop.
+ */
+class Telemetry : private juce::Timer
+{
+public:
+
+	~Telemetry() override;
+
+	/* Subscribes while it exists. Only create or destroy these on the message thread. */
+	struct Listener
+	{
+		using Callback = std::function<void (const TelemetryRecord&)>;
+
+		Listener (Telemetry& telemetryToUse, Callback&& callbackToUse);
+		~Listener();
+
+		Telemetry& telemetry;
+		Callback   callback;
+
+		JUCE_DECLARE_NON_COPYABLE (Listener)
+	};
+
+	/* Any thread may subscribe or unsubscribe; the engine starts or stops measuring at its next block. */
+	void subscribe() noexcept;
+	void unsubscribe() noexcept;
+
+	bool pop (TelemetryRecord& record) noexcept;
+
+	/* Called by the audio thread at the start of every block, to clear the record being filled in.
+	   Returns false if nothing is subscribed, in which case nothing need be measured this block.
+	 */
+	bool beginBlock (int numSamples) noexcept;
+
+	/* Whether this block is being measured. Only call this from the audio thread. */
+	bool isActive() const noexcept { return active; }
+
+	/* A stage that runs several times per block reports the most it reduced the gain by. */
+	void reportGainReduction (TelemetryRecord::GainReduction stage, float decibels) noexcept;
+	void reportEffectLevel (TelemetryRecord::Effect effect, float decibels) noexcept;
+
+	/* The record being filled in this block. Only call this from the audio thread. */
+	TelemetryRecord& getRecord() noexcept { return current; }
+
+	/* Pushes this block's record, if it's being measured. If the ring is full, the record is dropped. */
+	void publish() noexcept;
+
+	static constexpr auto capacity = 256;
+
+	/* How often listeners are updated. */
+	static constexpr auto updatesPerSecond = 30;
+
+private:
+
+	void timerCallback() final;
+
+	std::array<TelemetryRecord, capacity> records;
+
+	std::atomic<juce::uint32> writePosition { 0 }, readPosition { 0 };
+
+	std::atomic<int> numSubscribers { 0 };
+
+	// only touched by the audio thread
+	TelemetryRecord current;
+	bool			active { false };
+
+	// only touched by the message thread
+	std::vector<Listener*> listeners;
+
+	static constexpr auto mask = static_cast<juce::uint32> (capacity - 1);
+
+	static_assert ((capacity & (capacity - 1)) == 0, "The capacity must be a power of 2");
+	static_assert (std::is_trivially_copyable_v<TelemetryRecord>);
+};
+
+}  // namespace Imogen
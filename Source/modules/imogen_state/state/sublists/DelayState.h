@@ -0,0 +1,46 @@
+#pragma once
+
+namespace Imogen
+{
+/* The parameters are added to the list by Parameters, since the toggle and mix were there before the
+   rest of the delay's, and have to keep their places.
+ */
+struct DelayState
+{
+	DelayState();
+
+	/* Note values the delay time can be synced to, from a thirty-second note up to a dotted half. */
+	static constexpr auto numDivisions = 12;
+
+	static double getDivisionInBeats (int division);
+	static String getDivisionName (int division);
+
+	ToggleParam	 delayToggle { "Delay toggle", false };
+	PercentParam delayDryWet { "Delay mix", 0 };
+
+	ToggleParam delaySync { "Delay sync", true };
+	SecParam	delayTime { 2.f, "Delay time", 0.375f };
+
+	IntParam delayDivision { 1, numDivisions, 6, "Delay division",
+							 [] (int value, int maxLength)
+							 { return getDivisionName (value).substring (0, maxLength); },
+							 [] (const juce::String& text)
+							 {
+								 for (auto i = 1; i <= numDivisions; ++i)
+									 if (text.trim() == getDivisionName (i))
+										 return i;
+
+								 return 6;
+							 } };
+
+	PercentParam delayFeedback { "Delay feedback", 35 };
+
+	IntParam delayTaps { 1, 4, 1, "Delay taps" };
+
+	PercentParam delayModDepth { "Delay mod depth", 0 };
+	FloatParam	 delayModRate { 0.05f, 5.f, 0.5f, "Delay mod rate" };
+
+	ParameterGroup changes;
+};
+
+}  // namespace Imogen
@@ -22,6 +22,8 @@ struct EQState
 	HzParam	   eqPeakFreq { "EQ peak freq", 80.f };
 	FloatParam eqPeakQ { 0.01f, 10.f, 0.707f, "EQ peak Q" };
 	FloatParam eqPeakGain { 0.f, 4.f, 1.f, "EQ peak gain" };
+
+	ParameterGroup changes;
 };
 
 }  // namespace Imogen
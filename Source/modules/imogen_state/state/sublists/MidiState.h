@@ -35,11 +35,22 @@ struct MidiState
 	PitchParam	   descantThresh { "Descant thresh", 127 };
 	SemitonesParam descantInterval { 12, "Descant interval", 12 };
 
+	/* Sends the lead's detected pitch, as notes and pitch bend, and the notes the harmony voices are
+	   playing out of the plugin's MIDI output, each on its own channel, as well as the MIDI passed through.
+	 */
+	ToggleParam pitchToMidi { "Pitch to MIDI output", false };
+
+	static constexpr auto leadOutputChannel	   = 15;
+	static constexpr auto harmonyOutputChannel = 16;
+
 	IntParam editorPitchbend { 0, 127, 64, "GUI Pitchbend",
 							   [] (int value, int maximumStringLength)
 							   { return juce::String (value).substring (0, maximumStringLength); },
 							   [] (const juce::String& text)
 							   { return text.retainCharacters ("1234567890").getIntValue(); } };
+
+	// everything the harmonizer's synth settings are made from
+	ParameterGroup changes;
 };
 
 }  // namespace Imogen
@@ -0,0 +1,739 @@
+#include "Benchmarks.h"
+
+#include <iostream>
+
+namespace Imogen
+{
+void benchmarkVoices (double samplerate)
+{
+	constexpr auto numVoices	 = 16;
+	constexpr auto inputFreq	 = 200.f;
+	constexpr auto secondsToTime = 4.;
+
+	std::cout << "Block size\tVoices per core" << std::endl;
+
+	for (auto blocksize = 32; blocksize <= 1024; blocksize *= 2)
+	{
+		GrainCache<float> cache;
+		cache.prepare (samplerate, blocksize);
+
+		std::vector<std::unique_ptr<GrainShifter<float>>> shifters;
+
+		for (auto i = 0; i < numVoices; ++i)
+		{
+			auto& shifter = *shifters.emplace_back (std::make_unique<GrainShifter<float>> (cache));
+
+			shifter.prepare (blocksize);
+			shifter.setPitch (inputFreq * std::pow (2.f, static_cast<float> (i - numVoices / 2) / 12.f));
+		}
+
+		GrainBatch<float> batch;
+		batch.reserve (numVoices * shifters.front()->getMaxGrainsPerBlock (blocksize));
+
+		std::vector<float> input (static_cast<size_t> (blocksize)), output (input.size());
+
+		const auto numBlocks = static_cast<int> (secondsToTime * samplerate / blocksize);
+
+		juce::int64 samplesGenerated = 0, elapsedTicks = 0;
+
+		for (auto block = 0; block < numBlocks; ++block)
+		{
+			for (auto& sample : input)
+				sample = static_cast<float> (std::fmod (inputFreq * static_cast<double> (samplesGenerated++) / samplerate, 1.) * 2. - 1.);
+
+			cache.analyze (input.data(), blocksize, inputFreq);
+
+			const auto start = juce::Time::getHighResolutionTicks();
+
+			batch.clear();
+
+			for (auto& shifter : shifters)
+				shifter->queueGrains (blocksize, batch);
+
+			batch.process();
+
+			for (auto& shifter : shifters)
+				shifter->readSamples (output.data(), blocksize);
+
+			elapsedTicks += juce::Time::getHighResolutionTicks() - start;
+		}
+
+		const auto seconds = juce::Time::highResolutionTicksToSeconds (std::max (juce::int64 (1), elapsedTicks));
+
+		std::cout << blocksize << "\t\t" << juce::roundToInt (numVoices * secondsToTime / seconds) << std::endl;
+	}
+}
+
+template <typename Callback>
+static double timePerBlockMicros (int numBlocks, Callback&& processBlock)
+{
+	const auto start = juce::Time::getHighResolutionTicks();
+
+	for (auto block = 0; block < numBlocks; ++block)
+		processBlock();
+
+	const auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+
+	return seconds * 1.0e6 / numBlocks;
+}
+
+void benchmarkEQ (double samplerate)
+{
+	using FT	  = dsp::FX::FilterType;
+	using Cascade = BiquadCascade<float>;
+
+	constexpr auto numBlocks = 20000;
+
+	std::cout << "Block size\tTwo chains (us)\tCascade (us)" << std::endl;
+
+	for (auto blocksize = 32; blocksize <= 1024; blocksize *= 2)
+	{
+		juce::AudioBuffer<float> dry { 2, blocksize }, wet { 2, blocksize };
+
+		juce::Random rng;
+
+		for (auto* buffer : { &dry, &wet })
+			for (auto chan = 0; chan < 2; ++chan)
+				for (auto i = 0; i < blocksize; ++i)
+					buffer->setSample (chan, i, rng.nextFloat() * 2.f - 1.f);
+
+		dsp::FX::EQ<float> dryEQ, wetEQ;
+
+		for (auto* eq : { &dryEQ, &wetEQ })
+		{
+			eq->addBand (FT::LowShelf, 80.f);
+			eq->addBand (FT::HighShelf, 10000.f);
+			eq->addBand (FT::HighPass, 80.f);
+			eq->addBand (FT::Peak, 2500.f);
+			eq->prepare (samplerate, blocksize);
+		}
+
+		Cascade cascade { 4 };
+
+		cascade.setCoefficients (0, Cascade::Coefficients::makeLowShelf (samplerate, 80.f, 0.707f, 1.f));
+		cascade.setCoefficients (1, Cascade::Coefficients::makeHighShelf (samplerate, 10000.f, 0.707f, 1.f));
+		cascade.setCoefficients (2, Cascade::Coefficients::makeHighPass (samplerate, 80.f, 0.707f));
+		cascade.setCoefficients (3, Cascade::Coefficients::makePeak (samplerate, 2500.f, 0.707f, 1.f));
+
+		const auto twoChains = timePerBlockMicros (numBlocks, [&]
+												   {
+													   dryEQ.process (dry);
+													   wetEQ.process (wet);
+												   });
+
+		const auto fourLanes = timePerBlockMicros (numBlocks, [&]
+												   { cascade.process ({ dry.getWritePointer (0), dry.getWritePointer (1), wet.getWritePointer (0), wet.getWritePointer (1) }, blocksize); });
+
+		std::cout << blocksize << "\t\t" << twoChains << "\t\t" << fourLanes << std::endl;
+	}
+}
+
+template <typename SampleType>
+static double timeProcessorPerBlockMicros (double samplerate, int blocksize, int numBlocks)
+{
+	constexpr auto inputFreq = 200.;
+
+	Processor processor;
+	processor.setNonRealtime (true);
+	processor.setProcessingPrecision (std::is_same_v<SampleType, double> ? juce::AudioProcessor::doublePrecision
+																		 : juce::AudioProcessor::singlePrecision);
+	processor.prepareToPlay (samplerate, blocksize);
+
+	juce::AudioBuffer<SampleType> block { 2, blocksize };
+	juce::MidiBuffer			  midi;
+
+	for (auto note : { 57, 60, 64, 67 })
+		midi.addEvent (juce::MidiMessage::noteOn (1, note, 0.8f), 0);
+
+	juce::int64 samplesGenerated = 0;
+
+	const auto micros = timePerBlockMicros (numBlocks, [&]
+											{
+												for (auto i = 0; i < blocksize; ++i)
+												{
+													const auto sample = static_cast<SampleType> (std::fmod (inputFreq * static_cast<double> (samplesGenerated++) / samplerate, 1.) - 0.5);
+
+													block.setSample (0, i, sample);
+													block.setSample (1, i, sample);
+												}
+
+												processor.processBlock (block, midi);
+												midi.clear();
+											});
+
+	processor.releaseResources();
+
+	return micros;
+}
+
+void benchmarkPrecision (double samplerate)
+{
+	constexpr auto numBlocks = 2000;
+
+	std::cout << "Block size\tFloat (us)\tDouble (us)" << std::endl;
+
+	for (auto blocksize = 64; blocksize <= 1024; blocksize *= 2)
+	{
+		const auto singleMicros = timeProcessorPerBlockMicros<float> (samplerate, blocksize, numBlocks);
+		const auto doubleMicros = timeProcessorPerBlockMicros<double> (samplerate, blocksize, numBlocks);
+
+		std::cout << blocksize << "\t\t" << singleMicros << "\t\t" << doubleMicros << std::endl;
+	}
+}
+
+/*------------------------------------------------------------------------------------------*/
+
+// notes are started and stopped at random with about 24 held at once, between pitchbends and CCs
+static juce::MidiBuffer makeDenseMidiStream (int numSamples, int eventsPerBlock, int blocksize)
+{
+	juce::MidiBuffer midi;
+	juce::Random	 rng { 0x1a2b3c };
+
+	std::vector<int> held;
+
+	const auto numEvents = numSamples / blocksize * eventsPerBlock;
+
+	for (auto i = 0; i < numEvents; ++i)
+	{
+		const auto sample = static_cast<int> (static_cast<juce::int64> (i) * numSamples / numEvents);
+
+		const auto kind = rng.nextInt (10);
+
+		if (kind == 0)
+		{
+			midi.addEvent (juce::MidiMessage::pitchWheel (1, rng.nextInt (16384)), sample);
+		}
+		else if (kind == 1)
+		{
+			midi.addEvent (juce::MidiMessage::controllerEvent (1, 1 + rng.nextInt (64), rng.nextInt (128)), sample);
+		}
+		else if (held.size() < 24 && (held.empty() || rng.nextBool()))
+		{
+			const auto note = 36 + rng.nextInt (60);
+
+			midi.addEvent (juce::MidiMessage::noteOn (1, note, 0.3f + rng.nextFloat() * 0.7f), sample);
+			held.push_back (note);
+		}
+		else
+		{
+			const auto index = static_cast<size_t> (rng.nextInt (static_cast<int> (held.size())));
+
+			midi.addEvent (juce::MidiMessage::noteOff (1, held[index]), sample);
+			held.erase (held.begin() + static_cast<std::ptrdiff_t> (index));
+		}
+	}
+
+	return midi;
+}
+
+// the synth's previous behaviour: every lookup scans the pool, and the oldest voice is found by its stamp
+struct ScanningVoices
+{
+	struct Voice
+	{
+		int			 note { -1 };
+		juce::uint32 stamp { 0 };
+	};
+
+	explicit ScanningVoices (int numVoices) : voices (static_cast<size_t> (numVoices)) { }
+
+	Voice* getVoicePlayingNote (int note)
+	{
+		for (auto& voice : voices)
+			if (voice.note == note)
+				return &voice;
+
+		return nullptr;
+	}
+
+	Voice* findFreeVoice()
+	{
+		Voice* oldest = nullptr;
+
+		for (auto& voice : voices)
+		{
+			if (voice.note < 0)
+				return &voice;
+
+			if (oldest == nullptr || voice.stamp < oldest->stamp)
+				oldest = &voice;
+		}
+
+		return oldest;
+	}
+
+	void noteOn (int note)
+	{
+		auto* voice = getVoicePlayingNote (note);
+
+		if (voice == nullptr)
+			voice = findFreeVoice();
+
+		voice->note	 = note;
+		voice->stamp = ++lastStamp;
+	}
+
+	void noteOff (int note)
+	{
+		if (auto* voice = getVoicePlayingNote (note))
+			voice->note = -1;
+	}
+
+	std::vector<Voice> voices;
+	juce::uint32	   lastStamp { 0 };
+};
+
+struct IndexedVoices
+{
+	explicit IndexedVoices (int numVoices) { allocator.prepare (numVoices); }
+
+	void noteOn (int note)
+	{
+		if (allocator.getVoiceForNote (note) >= 0)
+			return;
+
+		const auto voice = allocator.allocate (true);
+		allocator.setNote (voice, note);
+	}
+
+	void noteOff (int note)
+	{
+		if (const auto voice = allocator.getVoiceForNote (note); voice >= 0)
+			allocator.release (voice);
+	}
+
+	VoiceAllocator allocator;
+};
+
+template <typename Voices>
+static double timeVoiceLookupNanos (const juce::MidiBuffer& midi, int numVoices, int numPasses)
+{
+	auto numEvents = 0;
+
+	const auto start = juce::Time::getHighResolutionTicks();
+
+	for (auto pass = 0; pass < numPasses; ++pass)
+	{
+		Voices voices { numVoices };
+
+		for (const auto metadata : midi)
+		{
+			const auto message = metadata.getMessage();
+
+			// with pedal and descant on, every note played can start up to two more
+			if (message.isNoteOn())
+				for (auto offset : { 0, -12, 12 })
+					voices.noteOn (message.getNoteNumber() + offset);
+			else if (message.isNoteOff())
+				for (auto offset : { 0, -12, 12 })
+					voices.noteOff (message.getNoteNumber() + offset);
+
+			++numEvents;
+		}
+	}
+
+	const auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+
+	return seconds * 1.0e9 / std::max (1, numEvents);
+}
+
+void benchmarkVoiceAllocation (double samplerate)
+{
+	constexpr auto blocksize	  = 256;
+	constexpr auto eventsPerBlock = 32;
+	constexpr auto numPasses	  = 50;
+
+	const auto numSamples = static_cast<int> (samplerate * 20.);
+
+	const auto midi = makeDenseMidiStream (numSamples, eventsPerBlock, blocksize);
+
+	std::cout << "Voices\t\tScan (ns per event)\tAllocator (ns per event)" << std::endl;
+
+	for (auto numVoices = 16; numVoices <= Internals::maxVoices; numVoices *= 2)
+	{
+		const auto scan	   = timeVoiceLookupNanos<ScanningVoices> (midi, numVoices, numPasses);
+		const auto indexed = timeVoiceLookupNanos<IndexedVoices> (midi, numVoices, numPasses);
+
+		std::cout << numVoices << "\t\t" << scan << "\t\t\t" << indexed << std::endl;
+	}
+
+	Processor processor;
+	processor.setNonRealtime (true);
+
+	auto& state = processor.getState();
+
+	state.internals.numVoices->set (Internals::maxVoices);
+	state.parameters.midiState.midiLatch->set (true);
+	state.parameters.midiState.pedalToggle->set (true);
+	state.parameters.midiState.descantToggle->set (true);
+
+	processor.prepareToPlay (samplerate, blocksize);
+
+	juce::AudioBuffer<float> block { 2, blocksize };
+	juce::MidiBuffer		 blockMidi;
+
+	juce::Random rng;
+
+	auto position = 0;
+
+	const auto micros = timePerBlockMicros (numSamples / blocksize, [&]
+											{
+												for (auto chan = 0; chan < 2; ++chan)
+													for (auto i = 0; i < blocksize; ++i)
+														block.setSample (chan, i, rng.nextFloat() * 0.5f - 0.25f);
+
+												blockMidi.clear();
+												blockMidi.addEvents (midi, position, blocksize, -position);
+												position += blocksize;
+
+												processor.processBlock (block, blockMidi);
+											});
+
+	processor.releaseResources();
+
+	std::cout << std::endl
+			  << "Dense MIDI through the plugin with " << Internals::maxVoices << " voices: " << micros << " us per block of " << blocksize << std::endl;
+}
+
+/*------------------------------------------------------------------------------------------*/
+
+void benchmarkStateChunk()
+{
+	constexpr auto numInstances = 100;
+	constexpr auto numRounds	= 20;
+
+	std::vector<std::unique_ptr<Processor>> instances;
+
+	juce::Random rng { 0x5eed };
+
+	for (auto i = 0; i < numInstances; ++i)
+	{
+		auto& processor = *instances.emplace_back (std::make_unique<Processor>());
+
+		for (auto* param : processor.getParameters())
+			param->setValueNotifyingHost (rng.nextFloat());
+	}
+
+	std::vector<juce::MemoryBlock> binary (numInstances), xml (numInstances);
+
+	const auto timeMicros = [] (auto&& callback)
+	{
+		const auto start = juce::Time::getHighResolutionTicks();
+
+		for (auto round = 0; round < numRounds; ++round)
+			callback();
+
+		return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start) * 1.0e6 / numRounds;
+	};
+
+	const auto binarySave = timeMicros ([&]
+										{
+											for (auto i = 0; i < numInstances; ++i)
+												instances[static_cast<size_t> (i)]->getStateInformation (binary[static_cast<size_t> (i)]);
+										});
+
+	const auto xmlSave = timeMicros ([&]
+									 {
+										 for (auto i = 0; i < numInstances; ++i)
+											 instances[static_cast<size_t> (i)]->getStateAsXml (xml[static_cast<size_t> (i)]);
+									 });
+
+	const auto binaryRestore = timeMicros ([&]
+										   {
+											   for (auto i = 0; i < numInstances; ++i)
+											   {
+												   const auto& block = binary[static_cast<size_t> (i)];
+												   instances[static_cast<size_t> (i)]->setStateInformation (block.getData(), static_cast<int> (block.getSize()));
+											   }
+										   });
+
+	const auto xmlRestore = timeMicros ([&]
+										{
+											for (auto i = 0; i < numInstances; ++i)
+											{
+												const auto& block = xml[static_cast<size_t> (i)];
+												instances[static_cast<size_t> (i)]->setStateFromXml (block.getData(), static_cast<int> (block.getSize()));
+											}
+										});
+
+	std::cout << "State for " << numInstances << " instances\tBinary\t\tXML" << std::endl
+			  << "Bytes per instance\t\t" << binary.front().getSize() << "\t\t" << xml.front().getSize() << std::endl
+			  << "Save all (us)\t\t\t" << binarySave << "\t\t" << xmlSave << std::endl
+			  << "Restore all (us)\t\t" << binaryRestore << "\t\t" << xmlRestore << std::endl;
+}
+
+/*------------------------------------------------------------------------------------------*/
+
+struct LabelledClip
+{
+	std::vector<float> audio;
+	double			   samplerate { 48000. };
+
+	// the true frequency at each labelled time, or 0 where the audio is unvoiced
+	std::vector<std::pair<double, float>> labels;
+};
+
+static std::vector<LabelledClip> loadPitchCorpus (const juce::File& folder)
+{
+	std::vector<LabelledClip> clips;
+
+	juce::AudioFormatManager formats;
+	formats.registerBasicFormats();
+
+	for (const auto& file : folder.findChildFiles (juce::File::findFiles, false, "*.wav"))
+	{
+		const auto labelFile = file.withFileExtension ("f0");
+
+		std::unique_ptr<juce::AudioFormatReader> reader { formats.createReaderFor (file) };
+
+		if (reader == nullptr || ! labelFile.existsAsFile())
+		{
+			std::cerr << "Skipping " << file.getFileName() << std::endl;
+			continue;
+		}
+
+		auto& clip = clips.emplace_back();
+
+		const auto numSamples = static_cast<int> (reader->lengthInSamples);
+
+		juce::AudioBuffer<float> buffer { 1, numSamples };
+		reader->read (&buffer, 0, numSamples, 0, true, false);
+
+		clip.samplerate = reader->sampleRate;
+		clip.audio.assign (buffer.getReadPointer (0), buffer.getReadPointer (0) + numSamples);
+
+		juce::StringArray lines;
+		labelFile.readLines (lines);
+
+		for (const auto& line : lines)
+		{
+			juce::StringArray tokens;
+			tokens.addTokens (line, " \t,", {});
+			tokens.removeEmptyStrings();
+
+			if (tokens.size() >= 2)
+				clip.labels.emplace_back (tokens[0].getDoubleValue(), tokens[1].getFloatValue());
+		}
+	}
+
+	return clips;
+}
+
+/* Sung-like notes across the vocal range: a band-limited pulse with vibrato and a little breath
+   noise, with a gap of unvoiced noise between each note.
+ */
+static std::vector<LabelledClip> makeSyntheticPitchCorpus (double samplerate)
+{
+	constexpr auto noteSeconds = 0.4, gapSeconds = 0.1, labelInterval = 0.01;
+
+	std::vector<LabelledClip> clips;
+
+	juce::Random rng { 0x0f0 };
+
+	for (const auto& melody : { std::vector<float> { 98.f, 131.f, 147.f, 196.f, 175.f, 131.f },
+								std::vector<float> { 220.f, 262.f, 330.f, 294.f, 247.f, 220.f },
+								std::vector<float> { 392.f, 523.f, 659.f, 587.f, 494.f, 440.f } })
+	{
+		auto& clip = clips.emplace_back();
+
+		clip.samplerate = samplerate;
+
+		auto phase = 0.;
+
+		for (const auto baseFreq : melody)
+		{
+			const auto noteStart = static_cast<double> (clip.audio.size()) / samplerate;
+
+			const auto noteSamples = static_cast<int> (noteSeconds * samplerate);
+
+			for (auto i = 0; i < noteSamples; ++i)
+			{
+				const auto seconds = static_cast<double> (i) / samplerate;
+				const auto freq	   = baseFreq * std::pow (2., 0.3 / 12. * std::sin (juce::MathConstants<double>::twoPi * 5.5 * seconds));
+
+				phase += freq / samplerate;
+
+				auto sample = 0.;
+
+				for (auto harmonic = 1; harmonic * freq < samplerate * 0.45; ++harmonic)
+					sample += std::sin (juce::MathConstants<double>::twoPi * harmonic * phase) / std::pow (harmonic, 1.5);
+
+				clip.audio.push_back (static_cast<float> (0.3 * sample) + (rng.nextFloat() - 0.5f) * 0.01f);
+
+				if (i % static_cast<int> (labelInterval * samplerate) == 0)
+					clip.labels.emplace_back (noteStart + seconds, static_cast<float> (freq));
+			}
+
+			const auto gapStart = static_cast<double> (clip.audio.size()) / samplerate;
+
+			for (auto i = 0; i < static_cast<int> (gapSeconds * samplerate); ++i)
+				clip.audio.push_back ((rng.nextFloat() - 0.5f) * 0.05f);
+
+			// leave the edges of the gap unlabelled, where a detector's window straddles both sides
+			clip.labels.emplace_back (gapStart + gapSeconds * 0.5, 0.f);
+		}
+	}
+
+	return clips;
+}
+
+struct PitchScores
+{
+	int	   numVoiced { 0 }, numUnvoiced { 0 }, numGrossErrors { 0 }, numVoicingErrors { 0 }, numAccurate { 0 };
+	double totalCents { 0. }, cpuSeconds { 0. }, audioSeconds { 0. };
+};
+
+/* Runs a detector over a clip and scores each label against the estimate whose analysis window
+   is centred closest to it. analyze() returns the detected frequency, or 0 if unpitched.
+ */
+template <typename Analyze>
+static void scorePitchTrack (const LabelledClip& clip, int blocksize, int windowSize, PitchScores& scores, Analyze&& analyze)
+{
+	std::vector<double> times;
+	std::vector<float>	freqs;
+
+	juce::int64 elapsedTicks = 0;
+
+	const auto numSamples = static_cast<int> (clip.audio.size());
+
+	for (auto pos = 0; pos + blocksize <= numSamples; pos += blocksize)
+	{
+		const auto start = juce::Time::getHighResolutionTicks();
+		const auto freq	 = analyze (clip.audio.data() + pos, blocksize);
+		elapsedTicks += juce::Time::getHighResolutionTicks() - start;
+
+		times.push_back (static_cast<double> (pos + blocksize - windowSize / 2) / clip.samplerate);
+		freqs.push_back (freq);
+	}
+
+	scores.cpuSeconds += juce::Time::highResolutionTicksToSeconds (elapsedTicks);
+	scores.audioSeconds += static_cast<double> (numSamples) / clip.samplerate;
+
+	if (times.empty())
+		return;
+
+	for (const auto& [time, trueFreq] : clip.labels)
+	{
+		const auto next	   = static_cast<size_t> (std::lower_bound (times.begin(), times.end(), time) - times.begin());
+		const auto nearest = next > 0 && (next == times.size() || time - times[next - 1] < times[next] - time) ? next - 1 : next;
+
+		const auto detected = freqs[nearest];
+
+		if (trueFreq <= 0.f)
+		{
+			++scores.numUnvoiced;
+
+			if (detected > 0.f)
+				++scores.numVoicingErrors;
+
+			continue;
+		}
+
+		++scores.numVoiced;
+
+		if (detected <= 0.f)
+		{
+			++scores.numVoicingErrors;
+			continue;
+		}
+
+		const auto cents = std::abs (1200. * std::log2 (static_cast<double> (detected) / static_cast<double> (trueFreq)));
+
+		if (cents > 50.)
+		{
+			++scores.numGrossErrors;
+		}
+		else
+		{
+			++scores.numAccurate;
+			scores.totalCents += cents;
+		}
+	}
+}
+
+static void printPitchScores (const char* name, const PitchScores& scores)
+{
+	const auto percent = [] (int count, int total)
+	{ return total > 0 ? 100. * count / total : 0.; };
+
+	std::cout << name << "\t"
+			  << 1.0e6 * scores.cpuSeconds / std::max (1.0e-9, scores.audioSeconds) << "\t\t"
+			  << percent (scores.numGrossErrors, scores.numVoiced) << "\t\t"
+			  << percent (scores.numVoicingErrors, scores.numVoiced + scores.numUnvoiced) << "\t\t"
+			  << (scores.numAccurate > 0 ? scores.totalCents / scores.numAccurate : 0.) << std::endl;
+}
+
+void benchmarkPitchDetection (const juce::File& corpus)
+{
+	const auto clips = corpus.isDirectory() ? loadPitchCorpus (corpus) : makeSyntheticPitchCorpus (48000.);
+
+	if (clips.empty())
+	{
+		std::cerr << "No labelled clips found in " << corpus.getFullPathName() << std::endl;
+		return;
+	}
+
+	PitchScores detectorScores, analyzerScores;
+
+	for (const auto& clip : clips)
+	{
+		PitchDetector<float> detector;
+		detector.setFrequencyRange (60.f, GrainCache<float>::maxInputFreq);
+		detector.prepare (clip.samplerate);
+
+		// the engine feeds the detector in sub-blocks
+		scorePitchTrack (clip, 64, detector.getWindowSize(), detectorScores, [&] (const float* input, int numSamples)
+						 {
+							 detector.process (input, numSamples);
+							 return detector.getFrequency();
+						 });
+
+		// the analyzer needs blocks as long as its latency, which is what the engine used to give it
+		dsp::psola::Analyzer<float> analyzer;
+		analyzer.prepare (clip.samplerate, 512);
+
+		const auto analyzerBlocksize = std::max (1, analyzer.getLatencySamples());
+		analyzer.prepare (clip.samplerate, analyzerBlocksize);
+
+		scorePitchTrack (clip, analyzerBlocksize, analyzerBlocksize, analyzerScores, [&] (const float* input, int numSamples)
+						 {
+							 analyzer.analyzeInput (input, numSamples);
+							 return analyzer.isPitched() ? analyzer.getFrequency() : 0.f;
+						 });
+	}
+
+	std::cout << "Detector\tus per second\tGross errors (%)\tVoicing errors (%)\tMean error (cents)" << std::endl;
+
+	printPitchScores ("MPM (FFT)", detectorScores);
+	printPitchScores ("PSOLA analyzer", analyzerScores);
+
+	// above 32 kHz the detector decimates, so its cost should barely grow with the samplerate
+	std::cout << std::endl
+			  << "Samplerate\tDecimation\tus per second\tGross errors (%)" << std::endl;
+
+	for (const auto samplerate : { 44100., 48000., 96000., 192000. })
+	{
+		PitchScores scores;
+
+		PitchDetector<float> detector;
+		detector.setFrequencyRange (60.f, GrainCache<float>::maxInputFreq);
+		detector.prepare (samplerate);
+
+		for (const auto& clip : makeSyntheticPitchCorpus (samplerate))
+		{
+			detector.reset();
+
+			scorePitchTrack (clip, 64, detector.getWindowSize(), scores, [&] (const float* input, int numSamples)
+							 {
+								 detector.process (input, numSamples);
+								 return detector.getFrequency();
+							 });
+		}
+
+		std::cout << samplerate << "\t\t" << detector.getDecimation() << "\t\t"
+				  << 1.0e6 * scores.cpuSeconds / scores.audioSeconds << "\t\t"
+				  << 100. * scores.numGrossErrors / std::max (1, scores.numVoiced) << std::endl;
+	}
+}
+
+}  // namespace Imogen
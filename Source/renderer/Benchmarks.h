@@ -0,0 +1,43 @@
+#pragma once
+
+#include <imogen_dsp/imogen_dsp.h>
+
+namespace Imogen
+{
+/* Prints how many harmony voices one core can pitch shift in real time at the given samplerate,
+   for each power-of-two block size from 32 to 1024.
+ */
+void benchmarkVoices (double samplerate = 48000.);
+
+/* Prints how long the dry/wet EQ takes per block, run as two separate filter chains (as it used to
+   be) and as one four-channel cascade.
+ */
+void benchmarkEQ (double samplerate = 48000.);
+
+/* Prints how long the whole plugin takes per block with a four-note chord held, processing in single
+   and in double precision. With IMOGEN_MIXED_PRECISION on, the double engine converts at its boundary
+   and runs the float kernels, so the two columns should be close.
+ */
+void benchmarkPrecision (double samplerate = 48000.);
+
+/* Replays a dense stream of notes, pitchbend and CCs, and prints how long finding voices takes per
+   event with the Harmonizer's voice allocator and with the linear scans it replaced, for several
+   sizes of voice pool. Then replays the stream through the whole plugin with every voice enabled
+   and latch, pedal and descant on, and prints the time per block.
+ */
+void benchmarkVoiceAllocation (double samplerate = 48000.);
+
+/* Saves and restores the state of 100 plugin instances, as a host autosaving a session would, and
+   prints the size of each instance's state and the total time taken in the binary and XML forms.
+ */
+void benchmarkStateChunk();
+
+/* Compares the CPU cost and accuracy of the engine's pitch detector against the Lemons PSOLA
+   analyzer it replaced. The corpus is a folder of WAV files, each with a .f0 file of the same name
+   beside it that lists "<seconds> <Hz>" on each line, with 0 Hz wherever the audio is unvoiced.
+   Without a corpus, a synthetic one of sung-like notes with vibrato and noisy gaps is used.
+   Also prints how the detector's cost changes with the samplerate.
+ */
+void benchmarkPitchDetection (const juce::File& corpus = {});
+
+}  // namespace Imogen
@@ -0,0 +1,104 @@
+#include "HarmonyCheck.h"
+
+#include <iostream>
+
+namespace Imogen
+{
+/* A harmonizer and its grain cache, fed a steady sawtooth. */
+class HarmonyRig
+{
+public:
+
+	HarmonyRig (double samplerateToUse, int blocksizeToUse)
+		: samplerate (samplerateToUse), blocksize (blocksizeToUse)
+	{
+		state.internals.numVoices->set (4);
+		state.parameters.midiState.pitchGlide->set (false);
+
+		harmonizer.initialize (Internals::maxVoices, samplerate, blocksize);
+
+		cache.prepare (samplerate, blocksize);
+		harmonizer.prepare (samplerate, blocksize);
+
+		input.resize (static_cast<size_t> (blocksize));
+		midi.ensureSize (4096);
+	}
+
+	const float* render()
+	{
+		for (auto& sample : input)
+		{
+			phase  = std::fmod (phase + inputFreq / samplerate, 1.);
+			sample = static_cast<float> (phase - 0.5);
+		}
+
+		cache.analyze (input.data(), blocksize, static_cast<float> (inputFreq));
+		harmonizer.process (blocksize, midi, false);
+
+		midi.clear();
+
+		return harmonizer.getHarmonySignal().getReadPointer (0);
+	}
+
+	MidiBuffer midi;
+
+private:
+
+	static constexpr auto inputFreq = 220.;
+
+	const double samplerate;
+	const int	 blocksize;
+
+	State			  state;
+	GrainCache<float> cache;
+	Harmonizer<float> harmonizer { state, cache };
+
+	std::vector<float> input;
+	double			   phase { 0. };
+};
+
+
+/* Renders two harmonizers holding the same note until the voices are rendering ahead, then bends
+   one of them halfway through a block. The two must match up to the pitchbend, and differ after
+   it in that same block.
+ */
+int runHarmonyCheck (int blocksize)
+{
+	constexpr auto samplerate	  = 48000.;
+	constexpr auto blocksToSettle = 16;
+
+	HarmonyRig bent { samplerate, blocksize }, unbent { samplerate, blocksize };
+
+	bent.midi.addEvent (juce::MidiMessage::noteOn (1, 60, 1.f), 0);
+	unbent.midi.addEvent (juce::MidiMessage::noteOn (1, 60, 1.f), 0);
+
+	for (auto block = 0; block < blocksToSettle; ++block)
+	{
+		bent.render();
+		unbent.render();
+	}
+
+	const auto bendAt = blocksize / 4;
+
+	bent.midi.addEvent (juce::MidiMessage::pitchWheel (1, 16383), bendAt);
+
+	const auto* a = bent.render();
+	const auto* b = unbent.render();
+
+	auto differenceBefore = 0.f, differenceAfter = 0.f;
+
+	for (auto i = 0; i < blocksize; ++i)
+	{
+		auto& difference = i < bendAt ? differenceBefore : differenceAfter;
+		difference		 = std::max (difference, std::abs (a[i] - b[i]));
+	}
+
+	const auto passed = differenceBefore == 0.f && differenceAfter > 1.0e-3f;
+
+	std::cout << (passed ? "PASS" : "FAIL") << "  pitchbend mid-block (largest difference before the bend "
+			  << differenceBefore << ", after it " << differenceAfter << ")" << std::endl;
+
+	return passed ? 0 : 1;
+}
+
+}  // namespace Imogen
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <imogen_dsp/imogen_dsp.h>
+
+namespace Imogen
+{
+/* Checks that the harmony voices follow a pitchbend from the sample it arrives at, even in the
+   middle of a block that the voices had started rendering ahead.
+   The harmonizer is driven directly, with whole blocks rather than the engine's sub-blocks, so
+   that a voice's prerendered audio can span the event.
+   Returns the number of checks that failed.
+ */
+int runHarmonyCheck (int blocksize = 1024);
+
+}  // namespace Imogen
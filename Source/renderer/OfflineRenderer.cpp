@@ -0,0 +1,179 @@
+#include "OfflineRenderer.h"
+
+#include <iostream>
+
+namespace Imogen
+{
+OfflineRenderer::OfflineRenderer (int blocksizeToUse)
+	: blocksize (blocksizeToUse)
+{
+	jassert (blocksize > 0);
+}
+
+bool OfflineRenderer::render (const RenderJob& job)
+{
+	juce::AudioFormatManager formats;
+	formats.registerBasicFormats();
+
+	std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (job.vocal));
+
+	if (reader == nullptr)
+		return fail ("Can't read audio file " + job.vocal.getFullPathName());
+
+	juce::MidiMessageSequence sequence;
+
+	if (! readMidi (job.midi, sequence))
+		return fail ("Can't read MIDI file " + job.midi.getFullPathName());
+
+	const auto samplerate = reader->sampleRate;
+	const auto numSamples = static_cast<int> (reader->lengthInSamples);
+
+	juce::AudioBuffer<float> vocal (2, numSamples);
+	reader->read (&vocal, 0, numSamples, 0, true, true);
+
+	Processor processor;
+	processor.setNonRealtime (true);
+	processor.prepareToPlay (samplerate, blocksize);
+
+	// the engine's output lags its input by this many samples, so we render past the
+	// end of the vocal and drop the first latency samples to line the render up with the source
+	const auto latency		= processor.getLatencySamples();
+	const auto totalSamples = numSamples + latency;
+
+	juce::AudioBuffer<float> rendered (2, totalSamples);
+	juce::AudioBuffer<float> block (2, blocksize);
+	juce::MidiBuffer		 midi;
+
+	auto nextEvent = 0;
+
+	for (auto pos = 0; pos < totalSamples; pos += blocksize)
+	{
+		const auto blockSamples = std::min (blocksize, totalSamples - pos);
+		const auto vocalSamples = juce::jlimit (0, blockSamples, numSamples - pos);
+
+		block.setSize (2, blockSamples, false, false, true);
+		block.clear();
+
+		for (auto chan = 0; chan < 2; ++chan)
+			if (vocalSamples > 0)
+				block.copyFrom (chan, 0, vocal, chan, pos, vocalSamples);
+
+		midi.clear();
+
+		for (; nextEvent < sequence.getNumEvents(); ++nextEvent)
+		{
+			const auto& message = sequence.getEventPointer (nextEvent)->message;
+
+			const auto samplePos = juce::roundToInt (message.getTimeStamp() * samplerate);
+
+			if (samplePos >= pos + blockSamples)
+				break;
+
+			midi.addEvent (message, std::max (0, samplePos - pos));
+		}
+
+		processor.processBlock (block, midi);
+
+		for (auto chan = 0; chan < 2; ++chan)
+			rendered.copyFrom (chan, pos, block, chan, 0, blockSamples);
+	}
+
+	processor.releaseResources();
+
+	job.output.deleteFile();
+
+	auto stream = job.output.createOutputStream();
+
+	if (stream == nullptr)
+		return fail ("Can't write to " + job.output.getFullPathName());
+
+	juce::WavAudioFormat wav;
+
+	std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (stream.get(), samplerate, 2, 24, {}, 0));
+
+	if (writer == nullptr)
+		return fail ("Can't create a WAV writer for " + job.output.getFullPathName());
+
+	stream.release();  // the writer now owns the stream
+
+	if (! writer->writeFromAudioSampleBuffer (rendered, latency, numSamples))
+		return fail ("Error writing " + job.output.getFullPathName());
+
+	return true;
+}
+
+bool OfflineRenderer::readMidi (const juce::File& file, juce::MidiMessageSequence& sequence)
+{
+	juce::FileInputStream stream { file };
+
+	if (! stream.openedOk())
+		return false;
+
+	juce::MidiFile midiFile;
+
+	if (! midiFile.readFrom (stream))
+		return false;
+
+	midiFile.convertTimestampTicksToSeconds();
+
+	for (auto track = 0; track < midiFile.getNumTracks(); ++track)
+		for (const auto* event : *midiFile.getTrack (track))
+			if (! event->message.isMetaEvent())
+				sequence.addEvent (event->message);
+
+	sequence.sort();
+
+	return true;
+}
+
+bool OfflineRenderer::fail (const String& message)
+{
+	lastError = message;
+	return false;
+}
+
+/*------------------------------------------------------------------------------------------*/
+
+BatchRenderer::BatchRenderer (int numThreadsToUse, int blocksizeToUse)
+	: numThreads (numThreadsToUse), blocksize (blocksizeToUse)
+{
+	jassert (numThreads > 0);
+}
+
+int BatchRenderer::renderAll (const juce::Array<RenderJob>& jobs)
+{
+	std::atomic<int> numFailed { 0 };
+
+	juce::ThreadPool pool { numThreads };
+
+	for (const auto& job : jobs)
+	{
+		pool.addJob ([this, job, &numFailed]
+					 {
+						 OfflineRenderer renderer { blocksize };
+
+						 if (renderer.render (job))
+						 {
+							 log ("Rendered " + job.output.getFullPathName());
+						 }
+						 else
+						 {
+							 log (renderer.getLastError());
+							 ++numFailed;
+						 }
+					 });
+	}
+
+	while (pool.getNumJobs() > 0)
+		juce::Thread::sleep (20);
+
+	return numFailed.load();
+}
+
+void BatchRenderer::log (const String& message)
+{
+	const juce::ScopedLock sl { logLock };
+	std::cout << message << std::endl;
+}
+
+}  // namespace Imogen
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <imogen_dsp/imogen_dsp.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+
+namespace Imogen
+{
+struct RenderJob
+{
+	juce::File vocal, midi, output;
+};
+
+
+class OfflineRenderer
+{
+public:
+
+	explicit OfflineRenderer (int blocksizeToUse = 512);
+
+	bool render (const RenderJob& job);
+
+	const String& getLastError() const noexcept { return lastError; }
+
+private:
+
+	bool fail (const String& message);
+
+	bool readMidi (const juce::File& file, juce::MidiMessageSequence& sequence);
+
+	const int blocksize;
+
+	String lastError;
+};
+
+
+class BatchRenderer
+{
+public:
+
+	BatchRenderer (int numThreadsToUse, int blocksizeToUse);
+
+	/* Renders every job and returns the number of jobs that failed. */
+	int renderAll (const juce::Array<RenderJob>& jobs);
+
+private:
+
+	void log (const String& message);
+
+	const int numThreads, blocksize;
+
+	juce::CriticalSection logLock;
+};
+
+}  // namespace Imogen
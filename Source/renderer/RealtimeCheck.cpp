@@ -0,0 +1,713 @@
+#include "RealtimeCheck.h"
+
+#include <iostream>
+
+#if JUCE_LINUX && defined(__GLIBC__)
+#	define IMOGEN_INTERPOSE_LIBC 1
+#	include <cerrno>
+#	include <cstdarg>
+#	include <dlfcn.h>
+#	include <fcntl.h>
+#	include <pthread.h>
+#	include <semaphore.h>
+#	include <unistd.h>
+#else
+#	define IMOGEN_INTERPOSE_LIBC 0
+#endif
+
+namespace Imogen::rt
+{
+enum class Call
+{
+	allocation,
+	deallocation,
+	mutexLock,
+	conditionWait,
+	semaphoreWait,
+	sleep,
+	fileIO,
+	numCalls
+};
+
+static constexpr auto numCalls = static_cast<size_t> (Call::numCalls);
+
+static const char* getCallName (size_t call)
+{
+	switch (static_cast<Call> (call))
+	{
+		case (Call::allocation) : return "allocation";
+		case (Call::deallocation) : return "deallocation";
+		case (Call::mutexLock) : return "mutex lock";
+		case (Call::conditionWait) : return "condition variable wait";
+		case (Call::semaphoreWait) : return "semaphore wait";
+		case (Call::sleep) : return "sleep";
+		case (Call::fileIO) : return "file I/O";
+		default : return "";
+	}
+}
+
+// only set on the thread running the processor, and only while it's inside processBlock
+static thread_local bool inRealtimeSection = false;
+
+static std::array<std::atomic<int>, numCalls> violations;
+
+static void noteCall (Call call) noexcept
+{
+	if (inRealtimeSection)
+		violations[static_cast<size_t> (call)].fetch_add (1, std::memory_order_relaxed);
+}
+
+struct ScopedRealtimeSection
+{
+	ScopedRealtimeSection() noexcept { inRealtimeSection = true; }
+	~ScopedRealtimeSection() { inRealtimeSection = false; }
+};
+
+}  // namespace Imogen::rt
+
+/*------------------------------------------------------------------------------------------*/
+
+#if IMOGEN_INTERPOSE_LIBC
+
+// These replace the C library's own definitions for the whole program, including calls made from
+// shared libraries, since the renderer exports its symbols. glibc's allocator can be called
+// directly; everything else is looked up once, before any checking starts.
+
+extern "C"
+{
+	void* __libc_malloc (size_t);
+	void* __libc_calloc (size_t, size_t);
+	void* __libc_realloc (void*, size_t);
+	void* __libc_memalign (size_t, size_t);
+	void  __libc_free (void*);
+
+	void* malloc (size_t size)
+	{
+		Imogen::rt::noteCall (Imogen::rt::Call::allocation);
+		return __libc_malloc (size);
+	}
+
+	void* calloc (size_t num, size_t size)
+	{
+		Imogen::rt::noteCall (Imogen::rt::Call::allocation);
+		return __libc_calloc (num, size);
+	}
+
+	void* realloc (void* ptr, size_t size)
+	{
+		Imogen::rt::noteCall (Imogen::rt::Call::allocation);
+		return __libc_realloc (ptr, size);
+	}
+
+	void* memalign (size_t alignment, size_t size)
+	{
+		Imogen::rt::noteCall (Imogen::rt::Call::allocation);
+		return __libc_memalign (alignment, size);
+	}
+
+	void* aligned_alloc (size_t alignment, size_t size)
+	{
+		Imogen::rt::noteCall (Imogen::rt::Call::allocation);
+		return __libc_memalign (alignment, size);
+	}
+
+	int posix_memalign (void** result, size_t alignment, size_t size)
+	{
+		Imogen::rt::noteCall (Imogen::rt::Call::allocation);
+
+		if (alignment % sizeof (void*) != 0 || (alignment & (alignment - 1)) != 0)
+			return EINVAL;
+
+		auto* ptr = __libc_memalign (alignment, size);
+
+		if (ptr == nullptr)
+			return ENOMEM;
+
+		*result = ptr;
+		return 0;
+	}
+
+	void free (void* ptr)
+	{
+		if (ptr != nullptr)
+			Imogen::rt::noteCall (Imogen::rt::Call::deallocation);
+
+		__libc_free (ptr);
+	}
+}
+
+namespace Imogen::rt
+{
+template <typename Function>
+static Function* findNext (Function*& cached, const char* name) noexcept
+{
+	if (cached == nullptr)
+		cached = reinterpret_cast<Function*> (dlsym (RTLD_NEXT, name));
+
+	return cached;
+}
+
+/* glibc keeps an old version of the condition variable functions for binaries built before 2.3.2,
+   which is what plain dlsym finds, and which would corrupt a condition variable the rest of the
+   program uses with the current version.
+ */
+template <typename Function>
+static Function* findNextCondition (Function*& cached, const char* name) noexcept
+{
+	if (cached == nullptr)
+		cached = reinterpret_cast<Function*> (dlvsym (RTLD_NEXT, name, "GLIBC_2.3.2"));
+
+	return findNext (cached, name);
+}
+
+static decltype (&pthread_mutex_lock)	  nextMutexLock		= nullptr;
+static decltype (&pthread_cond_wait)	  nextCondWait		= nullptr;
+static decltype (&pthread_cond_timedwait) nextCondTimedWait = nullptr;
+static decltype (&sem_wait)				  nextSemWait		= nullptr;
+static decltype (&sem_timedwait)		  nextSemTimedWait	= nullptr;
+static decltype (&nanosleep)			  nextNanosleep		= nullptr;
+static decltype (&usleep)				  nextUsleep		= nullptr;
+static int (*nextOpen) (const char*, int, ...)				= nullptr;
+static decltype (&read)					  nextRead			= nullptr;
+static decltype (&write)				  nextWrite			= nullptr;
+
+// dlsym can allocate the first time it's called, so everything is resolved before checking starts
+static void resolveInterposedFunctions()
+{
+	findNext (nextMutexLock, "pthread_mutex_lock");
+	findNextCondition (nextCondWait, "pthread_cond_wait");
+	findNextCondition (nextCondTimedWait, "pthread_cond_timedwait");
+	findNext (nextSemWait, "sem_wait");
+	findNext (nextSemTimedWait, "sem_timedwait");
+	findNext (nextNanosleep, "nanosleep");
+	findNext (nextUsleep, "usleep");
+	findNext (nextOpen, "open");
+	findNext (nextRead, "read");
+	findNext (nextWrite, "write");
+}
+
+}  // namespace Imogen::rt
+
+extern "C"
+{
+	int pthread_mutex_lock (pthread_mutex_t* mutex)
+	{
+		Imogen::rt::noteCall (Imogen::rt::Call::mutexLock);
+		return Imogen::rt::findNext (Imogen::rt::nextMutexLock, "pthread_mutex_lock") (mutex);
+	}
+
+	int pthread_cond_wait (pthread_cond_t* cond, pthread_mutex_t* mutex)
+	{
+		Imogen::rt::noteCall (Imogen::rt::Call::conditionWait);
+		return Imogen::rt::findNextCondition (Imogen::rt::nextCondWait, "pthread_cond_wait") (cond, mutex);
+	}
+
+	int pthread_cond_timedwait (pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* time)
+	{
+		Imogen::rt::noteCall (Imogen::rt::Call::conditionWait);
+		return Imogen::rt::findNextCondition (Imogen::rt::nextCondTimedWait, "pthread_cond_timedwait") (cond, mutex, time);
+	}
+
+	int sem_wait (sem_t* sem)
+	{
+		Imogen::rt::noteCall (Imogen::rt::Call::semaphoreWait);
+		return Imogen::rt::findNext (Imogen::rt::nextSemWait, "sem_wait") (sem);
+	}
+
+	int sem_timedwait (sem_t* sem, const struct timespec* time)
+	{
+		Imogen::rt::noteCall (Imogen::rt::Call::semaphoreWait);
+		return Imogen::rt::findNext (Imogen::rt::nextSemTimedWait, "sem_timedwait") (sem, time);
+	}
+
+	int nanosleep (const struct timespec* duration, struct timespec* remaining)
+	{
+		Imogen::rt::noteCall (Imogen::rt::Call::sleep);
+		return Imogen::rt::findNext (Imogen::rt::nextNanosleep, "nanosleep") (duration, remaining);
+	}
+
+	int usleep (useconds_t micros)
+	{
+		Imogen::rt::noteCall (Imogen::rt::Call::sleep);
+		return Imogen::rt::findNext (Imogen::rt::nextUsleep, "usleep") (micros);
+	}
+
+	int open (const char* path, int flags, ...)
+	{
+		Imogen::rt::noteCall (Imogen::rt::Call::fileIO);
+
+		mode_t mode = 0;
+
+		if ((flags & O_CREAT) != 0)
+		{
+			va_list args;
+			va_start (args, flags);
+			mode = static_cast<mode_t> (va_arg (args, int));
+			va_end (args);
+		}
+
+		return Imogen::rt::findNext (Imogen::rt::nextOpen, "open") (path, flags, mode);
+	}
+
+	ssize_t read (int fd, void* buffer, size_t numBytes)
+	{
+		Imogen::rt::noteCall (Imogen::rt::Call::fileIO);
+		return Imogen::rt::findNext (Imogen::rt::nextRead, "read") (fd, buffer, numBytes);
+	}
+
+	ssize_t write (int fd, const void* buffer, size_t numBytes)
+	{
+		Imogen::rt::noteCall (Imogen::rt::Call::fileIO);
+		return Imogen::rt::findNext (Imogen::rt::nextWrite, "write") (fd, buffer, numBytes);
+	}
+}
+
+#else
+
+// without glibc, only allocations made through operator new can be seen
+
+void* operator new (std::size_t size)
+{
+	Imogen::rt::noteCall (Imogen::rt::Call::allocation);
+
+	if (auto* ptr = std::malloc (size > 0 ? size : 1))
+		return ptr;
+
+	throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)
+{
+	return operator new (size);
+}
+
+void operator delete (void* ptr) noexcept
+{
+	if (ptr != nullptr)
+		Imogen::rt::noteCall (Imogen::rt::Call::deallocation);
+
+	std::free (ptr);
+}
+
+void operator delete[] (void* ptr) noexcept
+{
+	operator delete (ptr);
+}
+
+void operator delete (void* ptr, std::size_t) noexcept
+{
+	operator delete (ptr);
+}
+
+void operator delete[] (void* ptr, std::size_t) noexcept
+{
+	operator delete (ptr);
+}
+
+namespace Imogen::rt
+{
+static void resolveInterposedFunctions() { }
+}  // namespace Imogen::rt
+
+#endif
+
+/*------------------------------------------------------------------------------------------*/
+
+namespace Imogen
+{
+/* Drives a processor the way a host would: parameter changes, presets and MIDI are set up between
+   blocks, and only the processBlock calls themselves are checked.
+ */
+class RealtimeChecker
+{
+public:
+
+	RealtimeChecker (int maxBlocksizeToUse, bool useDoublePrecision)
+		: maxBlocksize (maxBlocksizeToUse), doublePrecision (useDoublePrecision)
+	{
+		processor.setProcessingPrecision (doublePrecision ? juce::AudioProcessor::doublePrecision
+														  : juce::AudioProcessor::singlePrecision);
+
+		midi.ensureSize (midiBufferBytes);
+	}
+
+	void prepare (double newSamplerate)
+	{
+		samplerate = newSamplerate;
+
+		processor.releaseResources();
+		processor.prepareToPlay (samplerate, maxBlocksize);
+
+		const auto numChannels = std::max (processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+
+		floatAudio.setSize (numChannels, maxBlocksize);
+		doubleAudio.setSize (numChannels, maxBlocksize);
+	}
+
+	template <typename Callback>
+	void render (int numBlocks, Callback&& beforeEachBlock)
+	{
+		for (auto block = 0; block < numBlocks; ++block)
+		{
+			// most hosts use a fixed block size, but some split blocks around automation or loop points
+			const auto numSamples = rng.nextInt (4) == 0 ? rng.nextInt ({ 1, maxBlocksize + 1 }) : maxBlocksize;
+
+			midi.clear();
+			addRandomNotes (numSamples, 0.2f);
+
+			beforeEachBlock (block, numSamples);
+
+			if (doublePrecision)
+				renderBlock (doubleAudio, numSamples);
+			else
+				renderBlock (floatAudio, numSamples);
+		}
+	}
+
+	/* The first time convolution is switched on, it starts the timer that starts its threads, which
+	   is a one-off in a processor's life rather than part of processing, so it's done here, unchecked.
+	 */
+	void warmUpConvolution()
+	{
+		auto& reverb = parameters.reverbState;
+
+		const auto reverbWasOn		= reverb.reverbToggle->get();
+		const auto convolutionWasOn = reverb.reverbConvolution->get();
+
+		reverb.reverbToggle->set (true);
+		reverb.reverbConvolution->set (true);
+
+		// enough blocks for the input to get through the gate and reach the reverb
+		for (auto block = 0; block < 8; ++block)
+		{
+			midi.clear();
+
+			if (doublePrecision)
+				renderBlock (doubleAudio, maxBlocksize, false);
+			else
+				renderBlock (floatAudio, maxBlocksize, false);
+		}
+
+		reverb.reverbToggle->set (reverbWasOn);
+		reverb.reverbConvolution->set (convolutionWasOn);
+	}
+
+	void addRandomNotes (int numSamples, float probability)
+	{
+		if (rng.nextFloat() >= probability)
+			return;
+
+		const auto note	  = rng.nextInt ({ 36, 97 });
+		const auto sample = rng.nextInt (numSamples);
+
+		if (heldNotes[static_cast<size_t> (note)])
+			midi.addEvent (juce::MidiMessage::noteOff (1, note), sample);
+		else
+			midi.addEvent (juce::MidiMessage::noteOn (1, note, rng.nextFloat()), sample);
+
+		heldNotes[static_cast<size_t> (note)] = ! heldNotes[static_cast<size_t> (note)];
+	}
+
+	Processor processor;
+
+	State&		state { processor.getState() };
+	Parameters& parameters { state.parameters };
+
+	MidiBuffer	 midi;
+	juce::Random rng { 0x1309 };
+
+	static constexpr auto midiBufferBytes = 4096;
+
+private:
+
+	template <typename SampleType>
+	void renderBlock (juce::AudioBuffer<SampleType>& audio, int numSamples, bool checked = true)
+	{
+		audio.setSize (audio.getNumChannels(), numSamples, false, false, true);
+
+		writeInput (audio);
+
+		if (! checked)
+		{
+			processor.processBlock (audio, midi);
+			return;
+		}
+
+		const rt::ScopedRealtimeSection realtime;
+
+		processor.processBlock (audio, midi);
+	}
+
+	/* A sawtooth gliding between 100 and 400 Hz, which drops out for one second in every four so
+	   that the engine goes idle and wakes up again.
+	 */
+	template <typename SampleType>
+	void writeInput (juce::AudioBuffer<SampleType>& audio)
+	{
+		for (auto i = 0; i < audio.getNumSamples(); ++i)
+		{
+			const auto seconds = static_cast<double> (samplesRendered++) / samplerate;
+
+			auto sample = SampleType (0);
+
+			if (std::fmod (seconds, 4.) < 3.)
+			{
+				const auto freq = 250. + 150. * std::sin (seconds);
+
+				phase  = std::fmod (phase + freq / samplerate, 1.);
+				sample = static_cast<SampleType> (phase - 0.5);
+			}
+
+			for (auto chan = 0; chan < audio.getNumChannels(); ++chan)
+				audio.setSample (chan, i, sample);
+		}
+	}
+
+	const int  maxBlocksize;
+	const bool doublePrecision;
+
+	double samplerate { 48000. };
+
+	juce::AudioBuffer<float>  floatAudio;
+	juce::AudioBuffer<double> doubleAudio;
+
+	juce::int64 samplesRendered { 0 };
+	double		phase { 0. };
+
+	std::array<bool, 128> heldNotes {};
+};
+
+/*------------------------------------------------------------------------------------------*/
+
+static bool reportViolations (const char* scenario)
+{
+	juce::StringArray calls;
+
+	for (size_t i = 0; i < rt::numCalls; ++i)
+		if (const auto count = rt::violations[i].exchange (0); count > 0)
+			calls.add (juce::String (count) + " x " + rt::getCallName (i));
+
+	if (calls.isEmpty())
+	{
+		std::cout << scenario << ": ok" << std::endl;
+		return true;
+	}
+
+	std::cout << scenario << ": FAILED (" << calls.joinIntoString (", ") << ")" << std::endl;
+	return false;
+}
+
+template <typename Scenario>
+static bool runScenario (const char* name, int blocksize, bool doublePrecision, Scenario&& scenario)
+{
+	RealtimeChecker checker { blocksize, doublePrecision };
+
+	checker.prepare (48000.);
+	checker.warmUpConvolution();
+
+	for (auto& count : rt::violations)
+		count.store (0);
+
+	scenario (checker);
+
+	return reportViolations (name);
+}
+
+static void automateParameters (RealtimeChecker& checker)
+{
+	const auto& params = checker.processor.getParameters();
+
+	for (auto i = 0; i < 3; ++i)
+		params[checker.rng.nextInt (params.size())]->setValueNotifyingHost (checker.rng.nextFloat());
+}
+
+int runRealtimeCheck (int blocksize)
+{
+	rt::resolveInterposedFunctions();
+
+	constexpr auto numBlocks = 2000;
+
+	auto numFailed = 0;
+
+	const auto run = [&] (const char* name, bool doublePrecision, auto&& scenario)
+	{
+		if (! runScenario (name, blocksize, doublePrecision, scenario))
+			++numFailed;
+	};
+
+	const auto automation = [] (RealtimeChecker& checker)
+	{
+		checker.render (numBlocks, [&] (int, int)
+						{ automateParameters (checker); });
+	};
+
+	run ("Automation and MIDI", false, automation);
+	run ("Automation and MIDI, double precision", true, automation);
+
+	run ("Telemetry subscribed", false, [] (RealtimeChecker& checker)
+		 {
+			 auto& telemetry = checker.state.telemetry;
+
+			 telemetry.subscribe();
+
+			 TelemetryRecord record;
+
+			 checker.render (numBlocks, [&] (int block, int)
+							 {
+								 automateParameters (checker);
+
+								 // let the ring fill up now and then, so that dropping records is covered too
+								 if (block % 500 < 400)
+									 while (telemetry.pop (record))
+										 ;
+							 });
+
+			 telemetry.unsubscribe();
+		 });
+
+	run ("Preset changes", false, [] (RealtimeChecker& checker)
+		 {
+			 juce::MemoryBlock defaults, randomised;
+
+			 checker.processor.getStateInformation (defaults);
+
+			 for (auto* param : checker.processor.getParameters())
+				 param->setValueNotifyingHost (checker.rng.nextFloat());
+
+			 checker.processor.getStateInformation (randomised);
+
+			 checker.render (numBlocks, [&] (int block, int)
+							 {
+								 if (block % 50 != 0)
+									 return;
+
+								 const auto& preset = (block / 50) % 2 == 0 ? defaults : randomised;
+
+								 checker.processor.setStateInformation (preset.getData(), static_cast<int> (preset.getSize()));
+							 });
+		 });
+
+	run ("Preset library switching", false, [] (RealtimeChecker& checker)
+		 {
+			 const auto& parameters = checker.processor.getParameters();
+
+			 std::vector<PresetLibrary::Preset> presets (2);
+
+			 presets[0].name = "Defaults";
+			 presets[1].name = "Randomised";
+
+			 for (const auto* param : parameters)
+			 {
+				 const auto parameterID = PresetLibrary::getParameterID (*param);
+
+				 presets[0].values.emplace_back (parameterID, param->getDefaultValue());
+				 presets[1].values.emplace_back (parameterID, checker.rng.nextFloat());
+			 }
+
+			 const juce::TemporaryFile file { ".imogenpresets" };
+
+			 PresetLibrary::write (file.getFile(), presets);
+
+			 auto& library = checker.state.presets;
+			 library.open (file.getFile(), parameters);
+
+			 checker.render (numBlocks, [&] (int block, int)
+							 {
+								 if (block % 50 == 0)
+									 library.select ((block / 50) % 2);
+							 });
+
+			 library.open (PresetLibrary::getDefaultFile(), parameters);
+		 });
+
+	run ("Voice stealing", false, [] (RealtimeChecker& checker)
+		 {
+			 checker.state.internals.numVoices->set (4);
+			 checker.parameters.midiState.voiceStealing->set (true);
+
+			 checker.render (numBlocks, [&] (int block, int numSamples)
+							 {
+								 for (auto i = 0; i < 4; ++i)
+									 checker.addRandomNotes (numSamples, 0.9f);
+
+								 if (block % 100 == 0)
+									 checker.midi.addEvent (juce::MidiMessage::controllerEvent (1, 64, (block / 100) % 2 == 0 ? 127 : 0), 0);
+							 });
+		 });
+
+	run ("Full injected MIDI queue", false, [&numFailed] (RealtimeChecker& checker)
+		 {
+			 auto& queue = checker.state.midiInput;
+
+			 // the injected events are passed on in the host's buffer, which a host reuses from block to
+			 // block, so it only grows once; reserving that up front leaves just the engine's own buffers checked
+			 checker.midi.ensureSize (RealtimeChecker::midiBufferBytes + MidiInputQueue::bufferBytes);
+
+			 auto numRefused = 0;
+
+			 // every block takes a thousand events, so fewer of them are needed
+			 checker.render (numBlocks / 4, [&] (int, int numSamples)
+							 {
+								 // the whole queue is spread over the next block, so that every sub-block takes a share of it
+								 const auto blockStart = queue.getSamplePosition();
+
+								 for (auto i = 0; i < MidiInputQueue::capacity; i += 2)
+								 {
+									 const auto note	 = 36 + (i / 2) % 61;
+									 const auto position = blockStart + static_cast<juce::int64> (i) * numSamples / MidiInputQueue::capacity;
+
+									 if (! queue.pushAt (juce::MidiMessage::noteOn (1, note, 0.8f), position))
+										 ++numRefused;
+
+									 if (! queue.pushAt (juce::MidiMessage::noteOff (1, note), position))
+										 ++numRefused;
+								 }
+							 });
+
+			 // every block should drain the whole queue, or later blocks weren't given a full one
+			 if (numRefused > 0)
+			 {
+				 std::cout << "Full injected MIDI queue: " << numRefused << " events were refused" << std::endl;
+				 ++numFailed;
+			 }
+		 });
+
+	run ("Bypass toggles", false, [] (RealtimeChecker& checker)
+		 {
+			 auto& p = checker.parameters;
+
+			 const std::initializer_list<ToggleParam*> toggles { &p.leadBypass, &p.harmonyBypass, &p.noiseGateToggle, &p.deEsserToggle,
+																 &p.compToggle, &p.limiterToggle, &p.eqState.eqToggle,
+																 &p.reverbState.reverbToggle, &p.delayState.delayToggle };
+
+			 checker.render (numBlocks, [&] (int block, int)
+							 {
+								 if (block % 8 != 0)
+									 return;
+
+								 auto& toggle = **(toggles.begin() + checker.rng.nextInt (static_cast<int> (toggles.size())));
+
+								 toggle->set (! toggle->get());
+							 });
+		 });
+
+	run ("Samplerate changes", false, [] (RealtimeChecker& checker)
+		 {
+			 auto lowLatency = false;
+
+			 for (const auto samplerate : { 44100., 96000., 22050., 192000., 48000. })
+			 {
+				 lowLatency = ! lowLatency;
+				 checker.state.internals.lowLatencyMode->set (lowLatency);
+
+				 checker.prepare (samplerate);
+
+				 checker.render (numBlocks / 5, [&] (int, int)
+								 { automateParameters (checker); });
+			 }
+		 });
+
+	return numFailed;
+}
+
+}  // namespace Imogen
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <imogen_dsp/imogen_dsp.h>
+
+namespace Imogen
+{
+/* Runs the processor through a set of scenarios and reports every call that isn't realtime safe
+   made from inside processBlock after the first prepareToPlay: heap allocations and frees, mutex
+   locks, and blocking system calls. The scenarios cover parameter automation with MIDI, with and
+   without the meters subscribed, preset changes from the host and from the preset library, voice
+   stealing, bypass toggles and samplerate changes.
+   Returns the number of scenarios that failed.
+
+   Only the calling thread is checked, not the voice render pool's workers. Allocations are caught
+   on every platform through operator new; malloc, locks and system calls are only interposed with
+   glibc, since other platforms need their own interposing mechanisms.
+ */
+int runRealtimeCheck (int blocksize = 512);
+
+}  // namespace Imogen
@@ -0,0 +1,143 @@
+#include "renderer/OfflineRenderer.h"
+#include "renderer/Benchmarks.h"
+#include "renderer/RealtimeCheck.h"
+#include "renderer/HarmonyCheck.h"
+
+#include <iostream>
+
+
+static void printUsage()
+{
+	std::cout << "Usage: ImogenRenderer [--jobs=<n>] [--blocksize=<n>] [--batch=<file>] [<vocal.wav> <harmony.mid> <output.wav> ...]\n"
+				 "       ImogenRenderer --benchmark [--corpus=<folder>]\n"
+				 "       ImogenRenderer --rt-check [--blocksize=<n>]\n"
+				 "       ImogenRenderer --harmony-check\n"
+				 "\n"
+				 "Renders each vocal/MIDI pair through Imogen to a WAV file, faster than real time.\n"
+				 "A batch file lists one job per line as three paths; paths containing spaces must be quoted.\n"
+				 "--benchmark measures how many harmony voices one core can render in real time, the cost of the EQ,\n"
+				 "the cost of the whole plugin in single and double precision, the cost of allocating voices for a\n"
+				 "dense MIDI stream, the size and cost of saving and restoring the state in binary and as XML,\n"
+				 "and the cost and accuracy of pitch detection, on a folder of WAV files with .f0\n"
+				 "label files if one is given.\n"
+				 "--rt-check fails if the audio callback allocates, locks or blocks in any of a set of test scenarios.\n"
+				 "--harmony-check fails if the harmony voices don't follow a pitchbend within the block it arrives in."
+			  << std::endl;
+}
+
+static juce::File getFile (const juce::String& path)
+{
+	return juce::File::getCurrentWorkingDirectory().getChildFile (path.unquoted());
+}
+
+static bool addJobs (const juce::StringArray& paths, juce::Array<Imogen::RenderJob>& jobs)
+{
+	if (paths.size() % 3 != 0)
+		return false;
+
+	for (auto i = 0; i < paths.size(); i += 3)
+		jobs.add ({ getFile (paths[i]), getFile (paths[i + 1]), getFile (paths[i + 2]) });
+
+	return true;
+}
+
+
+int main (int argc, char* argv[])
+{
+	juce::ScopedJuceInitialiser_GUI juceInit;
+
+	juce::ArgumentList args { argc, argv };
+
+	if (args.containsOption ("--help|-h"))
+	{
+		printUsage();
+		return 0;
+	}
+
+	if (args.containsOption ("--benchmark"))
+	{
+		Imogen::benchmarkVoices();
+		std::cout << std::endl;
+		Imogen::benchmarkEQ();
+		std::cout << std::endl;
+		Imogen::benchmarkPrecision();
+		std::cout << std::endl;
+		Imogen::benchmarkVoiceAllocation();
+		std::cout << std::endl;
+		Imogen::benchmarkStateChunk();
+		std::cout << std::endl;
+		Imogen::benchmarkPitchDetection (args.containsOption ("--corpus")
+											 ? getFile (args.getValueForOption ("--corpus"))
+											 : juce::File {});
+		return 0;
+	}
+
+	if (args.containsOption ("--rt-check"))
+	{
+		const auto blocksize = args.containsOption ("--blocksize|-b")
+								 ? args.getValueForOption ("--blocksize|-b").getIntValue()
+								 : 512;
+
+		return Imogen::runRealtimeCheck (std::max (1, blocksize)) > 0 ? 1 : 0;
+	}
+
+	if (args.containsOption ("--harmony-check"))
+		return Imogen::runHarmonyCheck() > 0 ? 1 : 0;
+
+	const auto numThreads = args.containsOption ("--jobs|-j")
+							  ? args.removeValueForOption ("--jobs|-j").getIntValue()
+							  : juce::SystemStats::getNumCpus();
+
+	const auto blocksize = args.containsOption ("--blocksize|-b")
+							 ? args.removeValueForOption ("--blocksize|-b").getIntValue()
+							 : 512;
+
+	juce::Array<Imogen::RenderJob> jobs;
+
+	if (args.containsOption ("--batch"))
+	{
+		const auto batchFile = getFile (args.removeValueForOption ("--batch"));
+
+		juce::StringArray lines;
+		batchFile.readLines (lines);
+
+		for (const auto& line : lines)
+		{
+			if (line.trim().isEmpty())
+				continue;
+
+			juce::StringArray paths;
+			paths.addTokens (line, " \t", "\"");
+			paths.removeEmptyStrings();
+
+			if (! addJobs (paths, jobs))
+			{
+				std::cerr << "Malformed line in batch file: " << line << std::endl;
+				return 1;
+			}
+		}
+	}
+
+	juce::StringArray paths;
+
+	for (const auto& arg : args.arguments)
+		paths.add (arg.text);
+
+	if (! addJobs (paths, jobs) || jobs.isEmpty() || numThreads < 1 || blocksize < 1)
+	{
+		printUsage();
+		return 1;
+	}
+
+	Imogen::BatchRenderer renderer { std::min (numThreads, jobs.size()), blocksize };
+
+	const auto numFailed = renderer.renderAll (jobs);
+
+	if (numFailed > 0)
+	{
+		std::cerr << numFailed << " of " << jobs.size() << " jobs failed" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}